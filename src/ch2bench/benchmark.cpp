@@ -0,0 +1,142 @@
+/**
+* @file benchmark.cpp
+* @author lakor64
+* @date 18/10/2026
+* @brief small benchmark harness
+*/
+#include "benchmark.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+
+void BenchState::AddCounter(const std::string& name, double value)
+{
+	for (auto& c : m_counters)
+	{
+		if (c.first == name)
+		{
+			c.second += value;
+			return;
+		}
+	}
+
+	m_counters.emplace_back(name, value);
+}
+
+std::vector<BenchResult> BenchRunner::Run(const std::string& filter, std::ostream* progress)
+{
+	std::vector<BenchResult> results;
+
+	for (const auto& b : m_benches)
+	{
+		if (!filter.empty() && b.name.find(filter) == std::string::npos)
+			continue;
+
+		if (progress)
+			*progress << "running " << b.name << std::endl;
+
+		if (b.setup && !b.setup())
+		{
+			if (progress)
+				*progress << "skipping " << b.name << ": setup failed" << std::endl;
+
+			continue;
+		}
+
+		BenchState state;
+
+		// warm up, the counters are not kept
+		b.run(state);
+		state.Clear();
+
+		BenchResult r;
+		r.name = b.name;
+		r.iterations = 0;
+		r.min_ms = 0;
+		r.max_ms = 0;
+
+		double total = 0;
+
+		while (r.iterations < m_max_iterations && (r.iterations < m_min_iterations || total < m_min_time))
+		{
+			const auto start = std::chrono::steady_clock::now();
+			b.run(state);
+			const auto t = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			r.min_ms = r.iterations == 0 ? t : std::min(r.min_ms, t);
+			r.max_ms = std::max(r.max_ms, t);
+			total += t;
+			r.iterations++;
+		}
+
+		if (b.teardown)
+			b.teardown();
+
+		r.mean_ms = total * 1000.0 / static_cast<double>(r.iterations);
+		r.min_ms *= 1000.0;
+		r.max_ms *= 1000.0;
+
+		for (const auto& c : state.GetCounters())
+			r.counters.emplace_back(c.first, c.second / static_cast<double>(r.iterations));
+
+		results.emplace_back(std::move(r));
+	}
+
+	return results;
+}
+
+void BenchRunner::WriteText(std::ostream& os, const std::vector<BenchResult>& results)
+{
+	const auto flags = os.flags();
+	const auto precision = os.precision();
+
+	os << std::left << std::setw(40) << "benchmark" << std::right << std::setw(12) << "mean (ms)" << std::setw(12) << "min (ms)"
+		<< std::setw(12) << "max (ms)" << std::setw(10) << "iters" << std::endl;
+	os << std::fixed << std::setprecision(3);
+
+	for (const auto& r : results)
+	{
+		os << std::left << std::setw(40) << r.name << std::right << std::setw(12) << r.mean_ms << std::setw(12) << r.min_ms
+			<< std::setw(12) << r.max_ms << std::setw(10) << r.iterations << std::endl;
+
+		for (const auto& c : r.counters)
+			os << "  " << std::left << std::setw(38) << c.first << std::right << std::setw(12) << c.second << std::endl;
+	}
+
+	os.flags(flags);
+	os.precision(precision);
+}
+
+void BenchRunner::WriteJson(std::ostream& os, const std::vector<BenchResult>& results)
+{
+	const auto flags = os.flags();
+	const auto precision = os.precision();
+
+	char date[32] = { 0 };
+	const auto now = std::time(nullptr);
+	std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::gmtime(&now));
+
+	os << std::fixed << std::setprecision(6);
+	os << "{\"context\":{\"date\":\"" << date << "\",\"build\":\"" << __TIMESTAMP__ << "\"},\"benchmarks\":[";
+
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const auto& r = results[i];
+
+		os << (i > 0 ? "," : "") << "\n{\"name\":\"" << r.name << "\",\"iterations\":" << r.iterations
+			<< ",\"time_unit\":\"ms\",\"mean\":" << r.mean_ms << ",\"min\":" << r.min_ms << ",\"max\":" << r.max_ms
+			<< ",\"counters\":{";
+
+		for (size_t k = 0; k < r.counters.size(); k++)
+			os << (k > 0 ? "," : "") << "\"" << r.counters[k].first << "\":" << r.counters[k].second;
+
+		os << "}}";
+	}
+
+	os << "\n]}" << std::endl;
+
+	os.flags(flags);
+	os.precision(precision);
+}
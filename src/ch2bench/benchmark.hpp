@@ -0,0 +1,147 @@
+/**
+* @file benchmark.hpp
+* @author lakor64
+* @date 18/10/2026
+* @brief small benchmark harness
+*/
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+* State passed to every iteration of a benchmark
+*/
+class BenchState final
+{
+public:
+	/**
+	* Adds a value to a counter, the counters are reported as the mean of the iterations
+	* @param name Name of the counter
+	* @param value Value to add
+	*/
+	void AddCounter(const std::string& name, double value);
+
+	/**
+	* Gets the counters
+	* @return Counters as name and total value
+	*/
+	constexpr const auto& GetCounters() const { return m_counters; }
+
+	/**
+	* Removes all the counters
+	*/
+	void Clear() { m_counters.clear(); }
+
+private:
+	/** counters in insertion order */
+	std::vector<std::pair<std::string, double>> m_counters;
+};
+
+/**
+* A registered benchmark
+*/
+struct Benchmark
+{
+	/** name of the benchmark (component/case) */
+	std::string name;
+	/** called once before the benchmark is run, the benchmark is skipped if it returns false, can be empty */
+	std::function<bool()> setup;
+	/** called for every iteration */
+	std::function<void(BenchState&)> run;
+	/** called once after the benchmark is run, can be empty */
+	std::function<void()> teardown;
+};
+
+/**
+* Result of a benchmark
+*/
+struct BenchResult
+{
+	/** name of the benchmark */
+	std::string name;
+	/** number of timed iterations */
+	uint64_t iterations;
+	/** mean time of an iteration in milliseconds */
+	double mean_ms;
+	/** fastest iteration in milliseconds */
+	double min_ms;
+	/** slowest iteration in milliseconds */
+	double max_ms;
+	/** mean value of the counters */
+	std::vector<std::pair<std::string, double>> counters;
+};
+
+/**
+* Runs the registered benchmarks, every benchmark is run once as warm up and
+*  then until the minimum time and number of iterations are reached
+*/
+class BenchRunner final
+{
+public:
+	/**
+	* Default constructor
+	*/
+	explicit BenchRunner() : m_min_time(0.5), m_min_iterations(3), m_max_iterations(1000000) {}
+
+	/**
+	* Registers a benchmark
+	* @param bench Benchmark to add
+	*/
+	void Add(Benchmark bench) { m_benches.emplace_back(std::move(bench)); }
+
+	/**
+	* Gets the registered benchmarks
+	* @return Benchmarks
+	*/
+	constexpr const auto& GetBenchmarks() const { return m_benches; }
+
+	/**
+	* Sets the minimum time of each benchmark
+	* @param seconds Time in seconds
+	*/
+	void SetMinTime(double seconds) { m_min_time = seconds; }
+
+	/**
+	* Sets the number of iterations of each benchmark
+	* @param min Minimum number of iterations
+	* @param max Maximum number of iterations
+	*/
+	void SetIterations(uint64_t min, uint64_t max) { m_min_iterations = min; m_max_iterations = max; }
+
+	/**
+	* Runs the benchmarks whose name contains the filter
+	* @param filter Filter, an empty filter runs every benchmark
+	* @param progress Stream that receives the progress, can be NULL
+	* @return Results of the benchmarks
+	*/
+	std::vector<BenchResult> Run(const std::string& filter, std::ostream* progress);
+
+	/**
+	* Writes the results as a table
+	* @param os Destination stream
+	* @param results Results to write
+	*/
+	static void WriteText(std::ostream& os, const std::vector<BenchResult>& results);
+
+	/**
+	* Writes the results as JSON
+	* @param os Destination stream
+	* @param results Results to write
+	*/
+	static void WriteJson(std::ostream& os, const std::vector<BenchResult>& results);
+
+private:
+	/** registered benchmarks */
+	std::vector<Benchmark> m_benches;
+	/** minimum time of each benchmark in seconds */
+	double m_min_time;
+	/** minimum number of iterations */
+	uint64_t m_min_iterations;
+	/** maximum number of iterations */
+	uint64_t m_max_iterations;
+};
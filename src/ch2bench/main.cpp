@@ -0,0 +1,400 @@
+/**
+* @file main.cpp
+* @author lakor64
+* @date 18/10/2026
+* @brief ch2inc benchmark suite
+*/
+#include "benchmark.hpp"
+
+#include <ch2parser.hpp>
+#include <headergen.hpp>
+#include <driverregistry.hpp>
+#include <cxxopts.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+/**
+* Clang arguments of the benchmarks (Linux x86-64)
+*/
+static const char* g_clang_args[] = {
+	"-D__H2INC__",
+	"-D__CH2INC__",
+	"-D__linux__",
+	"--target=x86_64-pc-linux-gnu",
+};
+
+/** number of clang arguments */
+static constexpr int g_clang_argc = static_cast<int>(sizeof(g_clang_args) / sizeof(g_clang_args[0]));
+
+/**
+* Phases reported by the parser benchmarks
+*/
+static constexpr ProfilePhase g_parse_phases[] = {
+	ProfilePhase::Index,
+	ProfilePhase::Parse,
+	ProfilePhase::Visit,
+	ProfilePhase::Macro,
+	ProfilePhase::Fixup,
+};
+
+/**
+* Gets the platform of the benchmarks
+* @return Platform info
+*/
+static PlatformInfo bench_platform()
+{
+	return PlatformInfo("linux", "64", true, CallType::Cdecl);
+}
+
+/**
+* Writes a synthetic header to the temporary directory
+* @param name Name of the header
+* @param cfg Shape of the header
+* @return Path of the header or an empty string in case of error
+*/
+static std::string write_header(const std::string& name, const HeaderGenConfig& cfg)
+{
+	const auto path = (std::filesystem::temp_directory_path() / ("ch2bench_" + name + ".h")).string();
+	std::ofstream ofs(path, std::ios::binary);
+
+	if (!ofs)
+		return "";
+
+	HeaderGen(cfg).Write(ofs);
+	return ofs ? path : "";
+}
+
+/**
+* Parses a header
+* @param path Header to parse
+* @param file File that receives the types
+* @param profiler Profiler of the parse, can be NULL
+* @return true if the header was parsed, otherwise false
+*/
+static bool parse_header(const std::string& path, CFile& file, Profiler* profiler)
+{
+	CH2Parser parser;
+	parser.SetProfiler(profiler);
+	parser.Visit(path, g_clang_argc, g_clang_args, file, bench_platform());
+
+	if (parser.HaveError())
+	{
+		std::cerr << "unable to parse " << path << ": " << CH2ErrorCodeStr(parser.GetLastError()) << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+/**
+* Writes the members of a file with the MASM driver
+* @param file File to write
+* @param out Destination sink
+* @param only Type of the members to write, MemberType::Primitive writes every member
+* @param jobs Threads used to write every member, 0 uses every core
+* @return Number of members written
+*/
+static size_t write_members(const CFile& file, OutputSink& out, MemberType only, unsigned jobs = 1)
+{
+	std::unique_ptr<Driver> drv(FindBuiltinDriver("masm")->create());
+
+	DriverConfig cfg;
+	cfg.out = &out;
+	cfg.platform = bench_platform();
+	cfg.jobs = jobs ? jobs : std::max(1u, std::thread::hardware_concurrency());
+	drv->SetConfig(cfg);
+
+	if (only == MemberType::Primitive)
+	{
+		drv->WriteFile(file);
+		return file.GetTypes().size();
+	}
+
+	size_t n = 0;
+
+	for (const auto& type : file.GetTypes())
+	{
+		const auto id = type->GetTypeID();
+
+		if (only != MemberType::Primitive && id != only)
+			continue;
+
+		switch (id)
+		{
+		case MemberType::Typedef:
+			drv->WriteTypeDef(*dynamic_cast<const Typedef*>(type));
+			break;
+		case MemberType::Union:
+			drv->WriteUnion(*dynamic_cast<const Union*>(type));
+			break;
+		case MemberType::Struct:
+			drv->WriteStruct(*dynamic_cast<const Struct*>(type));
+			break;
+		case MemberType::Enum:
+			drv->WriteEnum(*dynamic_cast<const Enum*>(type));
+			break;
+		case MemberType::Define:
+			drv->WriteDefine(*dynamic_cast<const Define*>(type));
+			break;
+		case MemberType::GlobalVar:
+			drv->WriteGlobalVar(*dynamic_cast<const GlobalVar*>(type));
+			break;
+		case MemberType::Function:
+			drv->WriteFunction(*dynamic_cast<const Function*>(type));
+			break;
+		default:
+			continue;
+		}
+
+		n++;
+	}
+
+	return n;
+}
+
+/**
+* Registers a benchmark that parses a synthetic header
+* @param runner Benchmark runner
+* @param name Name of the benchmark
+* @param cfg Shape of the header
+*/
+static void add_parse_bench(BenchRunner& runner, const std::string& name, const HeaderGenConfig& cfg)
+{
+	auto path = std::make_shared<std::string>();
+
+	Benchmark b;
+	b.name = name;
+	b.setup = [path, name, cfg]() {
+		auto file = name;
+		std::replace(file.begin(), file.end(), '/', '_');
+		*path = write_header(file, cfg);
+		return !path->empty();
+	};
+	b.run = [path](BenchState& state) {
+		Profiler profiler;
+		CFile file;
+
+		if (!parse_header(*path, file, &profiler))
+			return;
+
+		for (const auto phase : g_parse_phases)
+			state.AddCounter(std::string(Profiler::GetPhaseName(phase)) + "_ms", profiler.GetWallTime(phase) * 1000.0);
+
+		state.AddCounter("members", static_cast<double>(file.GetTypes().size()));
+	};
+	b.teardown = [path]() {
+		std::error_code ec;
+		std::filesystem::remove(*path, ec);
+	};
+
+	runner.Add(std::move(b));
+}
+
+/**
+* Registers the benchmarks of the MASM writers, the model is parsed once
+* @param runner Benchmark runner
+* @param cfg Shape of the header of the model
+*/
+static void add_writer_benches(BenchRunner& runner, const HeaderGenConfig& cfg)
+{
+	static const struct
+	{
+		const char* name;
+		MemberType only;
+		unsigned jobs;
+	} writers[] = {
+		{ "masm/typedef", MemberType::Typedef, 1 },
+		{ "masm/struct", MemberType::Struct, 1 },
+		{ "masm/union", MemberType::Union, 1 },
+		{ "masm/enum", MemberType::Enum, 1 },
+		{ "masm/define", MemberType::Define, 1 },
+		{ "masm/function", MemberType::Function, 1 },
+		{ "masm/all", MemberType::Primitive, 1 },
+		{ "masm/all_parallel", MemberType::Primitive, 0 },
+	};
+
+	auto model = std::make_shared<std::unique_ptr<CFile>>();
+
+	for (const auto& w : writers)
+	{
+		const auto only = w.only;
+		const auto jobs = w.jobs;
+
+		Benchmark b;
+		b.name = w.name;
+		b.setup = [model, cfg]() {
+			if (*model)
+				return true;
+
+			const auto path = write_header("writer_model", cfg);
+
+			if (path.empty())
+				return false;
+
+			auto file = std::make_unique<CFile>();
+			const auto ok = parse_header(path, *file, nullptr);
+
+			std::error_code ec;
+			std::filesystem::remove(path, ec);
+
+			if (ok)
+				*model = std::move(file);
+
+			return ok;
+		};
+		b.run = [model, only, jobs](BenchState& state) {
+			OutputSink out;
+			state.AddCounter("members", static_cast<double>(write_members(**model, out, only, jobs)));
+			state.AddCounter("bytes", static_cast<double>(out.GetSize()));
+		};
+
+		runner.Add(std::move(b));
+	}
+}
+
+/**
+* Registers an end-to-end benchmark of a user header (parse and MASM output)
+* @param runner Benchmark runner
+* @param path Header to convert
+*/
+static void add_header_bench(BenchRunner& runner, const std::string& path)
+{
+	Benchmark b;
+	b.name = "e2e/" + std::filesystem::path(path).filename().string();
+	b.run = [path](BenchState& state) {
+		Profiler profiler;
+		CFile file;
+
+		if (!parse_header(path, file, &profiler))
+			return;
+
+		OutputSink out;
+		profiler.Begin(ProfilePhase::Emit);
+		write_members(file, out, MemberType::Primitive);
+		profiler.End(ProfilePhase::Emit);
+
+		for (const auto phase : g_parse_phases)
+			state.AddCounter(std::string(Profiler::GetPhaseName(phase)) + "_ms", profiler.GetWallTime(phase) * 1000.0);
+
+		state.AddCounter("emit_ms", profiler.GetWallTime(ProfilePhase::Emit) * 1000.0);
+	};
+
+	runner.Add(std::move(b));
+}
+
+/**
+* Main entrypoint of the benchmark suite
+* @param argc Number of arguments
+* @param argv Arguments pointer
+* @return exit code
+*/
+int main(int argc, char** argv)
+{
+	cxxopts::Options opt("ch2inc_bench", "ch2inc benchmark suite");
+	opt.add_options()
+		("h,help", "Show this help screen")
+		("filter", "Run only the benchmarks whose name contains this string", cxxopts::value<std::string>()->default_value(""))
+		("min-time", "Minimum time of each benchmark in seconds", cxxopts::value<double>()->default_value("0.5"))
+		("min-iterations", "Minimum number of iterations of each benchmark", cxxopts::value<uint64_t>()->default_value("3"))
+		("max-iterations", "Maximum number of iterations of each benchmark", cxxopts::value<uint64_t>()->default_value("1000000"))
+		("json", "Write the results as JSON to this file (- for the standard output)", cxxopts::value<std::string>())
+		("header", "Add an end-to-end benchmark of a header", cxxopts::value<std::vector<std::string>>())
+		("preset", "Add a parser benchmark of a ch2gen preset (eg: windows)", cxxopts::value<std::string>())
+		("list", "List the benchmarks without running them")
+		;
+
+	cxxopts::ParseResult res;
+
+	try
+	{
+		res = opt.parse(argc, argv);
+	}
+	catch (std::exception& e)
+	{
+		std::cerr << e.what() << std::endl;
+		return -1;
+	}
+
+	if (res.count("help"))
+	{
+		std::cout << opt.help() << std::endl;
+		return 0;
+	}
+
+	BenchRunner runner;
+	runner.SetMinTime(res["min-time"].as<double>());
+	runner.SetIterations(res["min-iterations"].as<uint64_t>(), res["max-iterations"].as<uint64_t>());
+
+	HeaderGenConfig small, large;
+	HeaderGenConfig::GetPreset("small", small);
+	HeaderGenConfig::GetPreset("large", large);
+
+	HeaderGenConfig macros;
+	macros.macros = 2000;
+	macros.macro_chain = 16;
+
+	HeaderGenConfig nested;
+	nested.structs = 500;
+	nested.fields = 4;
+	nested.depth = 6;
+
+	add_parse_bench(runner, "visit/small", small);
+	add_parse_bench(runner, "visit/large", large);
+	add_parse_bench(runner, "macro/chains", macros);
+	add_parse_bench(runner, "fixup/nested", nested);
+	add_writer_benches(runner, large);
+
+	if (res.count("preset"))
+	{
+		HeaderGenConfig cfg;
+		const auto name = res["preset"].as<std::string>();
+
+		if (!HeaderGenConfig::GetPreset(name, cfg))
+		{
+			std::cerr << "Invalid preset" << std::endl;
+			return -1;
+		}
+
+		add_parse_bench(runner, "visit/preset_" + name, cfg);
+	}
+
+	if (res.count("header"))
+	{
+		for (const auto& h : res["header"].as<std::vector<std::string>>())
+			add_header_bench(runner, h);
+	}
+
+	if (res.count("list"))
+	{
+		for (const auto& b : runner.GetBenchmarks())
+			std::cout << b.name << std::endl;
+
+		return 0;
+	}
+
+	const auto results = runner.Run(res["filter"].as<std::string>(), &std::cerr);
+
+	if (!res.count("json"))
+		BenchRunner::WriteText(std::cout, results);
+	else if (res["json"].as<std::string>() == "-")
+		BenchRunner::WriteJson(std::cout, results);
+	else
+	{
+		std::ofstream ofs(res["json"].as<std::string>());
+
+		if (!ofs)
+		{
+			std::cerr << "Unable to open the JSON file" << std::endl;
+			return -2;
+		}
+
+		BenchRunner::WriteJson(ofs, results);
+	}
+
+	return 0;
+}
@@ -72,6 +72,7 @@ enum class MemberType
 };
 
 class CH2Parser;
+class PrimitiveTable;
 
 /**
 * Basic member of all the fields inside a file
@@ -79,6 +80,7 @@ class CH2Parser;
 class BasicMember
 {
 	friend CH2Parser;
+	friend PrimitiveTable;
 public:
 	/**
 	* Default deconstructor
@@ -8,6 +8,9 @@
 
 #include "basicmember.hpp"
 
+#include <cstdint>
+#include <vector>
+
 /**
 * Type of the define
 */
@@ -54,6 +57,49 @@ enum class DefineType
 	Text,
 };
 
+/**
+* Type of a token of a define expression
+*/
+enum class DefineTokenType
+{
+	/**
+	* Operator or parenthesis
+	*/
+	Operator,
+
+	/**
+	* Integer number
+	*/
+	Number,
+
+	/**
+	* Reference to another define
+	*/
+	Reference,
+};
+
+class Define;
+
+/**
+* A token of an evaluated define expression
+*/
+struct DefineToken
+{
+	/**
+	* Default constructor
+	*/
+	explicit DefineToken(DefineTokenType t) : type(t), number(0), ref(nullptr) {}
+
+	/** type of the token */
+	DefineTokenType type;
+	/** spelling of the operator or name of the referenced define */
+	std::string text;
+	/** value of the number */
+	uint64_t number;
+	/** referenced define */
+	const Define* ref;
+};
+
 /**
 * A C preprocessor definition
 * @note only basic definitions are supported, no function-like definition is actually supported
@@ -65,7 +111,7 @@ public:
 	/**
 	* Default constructor
 	*/
-	explicit Define() : BasicMember(MemberType::Define), m_defType(DefineType::None) {}
+	explicit Define() : BasicMember(MemberType::Define), m_defType(DefineType::None), m_number(0), m_hasNumber(false), m_unsigned(false) {}
 
 	/**
 	* Gets the value of the define
@@ -78,6 +124,39 @@ public:
 	* @return the define type
 	*/
 	constexpr auto GetDefineType() const { return m_defType; }
+
+	/**
+	* Checks if the define has an integer value
+	* @return true if the define is an integer, otherwise false
+	*/
+	constexpr auto HasNumber() const { return m_hasNumber; }
+
+	/**
+	* Gets the integer value of the define
+	* @return Value of the define (two's complement if signed)
+	*/
+	constexpr auto GetNumber() const { return m_number; }
+
+	/**
+	* Checks if the integer value is unsigned
+	* @return true if the value is unsigned, otherwise false
+	*/
+	constexpr auto IsUnsigned() const { return m_unsigned; }
+
+	/**
+	* Gets the defines referenced by this define
+	* @return Array of referenced defines
+	*/
+	constexpr const auto& GetDependencies() const { return m_deps; }
+
+	/**
+	* Gets the expression of an evaluated define
+	* @return Tokens of the expression, empty if the define was not evaluated
+	* @note this can be used to write the define as a reference to other defines instead of
+	*  the expanded value
+	*/
+	constexpr const auto& GetExpression() const { return m_expr; }
+
 private:
 	/**
 	* value of the define
@@ -88,4 +167,29 @@ private:
 	* Type of the define
 	*/
 	DefineType m_defType;
+
+	/**
+	* integer value of the define
+	*/
+	uint64_t m_number;
+
+	/**
+	* if the define has an integer value
+	*/
+	bool m_hasNumber;
+
+	/**
+	* if the integer value is unsigned
+	*/
+	bool m_unsigned;
+
+	/**
+	* referenced defines
+	*/
+	std::vector<const Define*> m_deps;
+
+	/**
+	* tokens of the evaluated expression
+	*/
+	std::vector<DefineToken> m_expr;
 };
@@ -12,7 +12,12 @@
 #include "function.hpp"
 #include "enum.hpp"
 #include "struct.hpp"
+#include "outputsink.hpp"
+#include "cfile.hpp"
+#include "emit.hpp"
+#include "tracer.hpp"
 
+#include <memory>
 #include <vector>
 #include <string>
 
@@ -24,22 +29,43 @@ struct DriverConfig
 	/**
 	* Default constructor
 	*/
-	explicit DriverConfig() : verbose(false), fp(nullptr) {}
+	explicit DriverConfig() : verbose(false), define_refs(false), fp(nullptr), out(nullptr), jobs(1), tracer(nullptr) {}
 
 	/**
 	* Verbose error message logging
 	*/
 	bool verbose;
 
+	/**
+	* Writes the defines as references to the defines they use (eg: FOO EQU BAR+4)
+	*  instead of the computed value, when the driver supports it
+	*/
+	bool define_refs;
+
 	/**
 	* Platform info
 	*/
 	PlatformInfo platform;
 
 	/**
-	* File pointer
+	* File pointer, only used when the output sink is not set
 	*/
 	FILE* fp;
+
+	/**
+	* Output sink that receives the text of the driver
+	*/
+	OutputSink* out;
+
+	/**
+	* Number of threads used by WriteFile, only when the driver supports the parallel write (DRIVER_CAP_PARALLEL_WRITE)
+	*/
+	unsigned jobs;
+
+	/**
+	* Trace of the conversion, the driver can add the spans of its own threads (can be NULL)
+	*/
+	Tracer* tracer;
 };
 
 /**
@@ -146,7 +172,29 @@ public:
 	* Sets the driver config
 	* @param cfg Driver config
 	*/
-	virtual void SetConfig(const DriverConfig& cfg) { m_cfg = cfg; }
+	virtual void SetConfig(const DriverConfig& cfg)
+	{
+		m_cfg = cfg;
+		m_fpsink.reset();
+
+		// hosts that only set the file pointer get a sink owned by the driver
+		if (!m_cfg.out && m_cfg.fp)
+		{
+			m_fpsink = std::make_unique<OutputSink>(m_cfg.fp);
+			m_cfg.out = m_fpsink.get();
+		}
+	}
+
+	/**
+	* Writes all the members of a file, this is called between WriteFileStart and WriteFileEnd.
+	* The default implementation writes every member with the Write* functions, drivers can
+	*  override it to do global passes over the whole file before writing the members
+	* @param file File to write
+	*/
+	virtual void WriteFile(const CFile& file)
+	{
+		EmitMembers(*this, file.GetTypes());
+	}
 
 protected:
 	/**
@@ -158,23 +206,109 @@ protected:
 	* Driver config
 	*/
 	DriverConfig m_cfg;
+
+	/**
+	* Sink of the file pointer of the config, if the host did not set one
+	*/
+	std::unique_ptr<OutputSink> m_fpsink;
 };
 
 
-/** callback that defines the entrypoint of the driver */
+/** callback that creates the driver, the caller must manually free the driver pointer */
 using DriverEntrypointFunc = Driver*(*)(void);
 
-/** driver entrypoint */
-#define DRIVER_ENTRYPOINT CH2DriverEntrypoint
+/**
+* Version of the driver interface (Driver, DriverConfig and DriverDescriptor),
+*  a driver built for a different version is rejected when it's loaded
+*/
+#define DRIVER_ABI_VERSION 2
+
+/**
+* Capabilities of a driver
+*/
+enum DriverCaps : uint32_t
+{
+	/** WriteFile can write the members on multiple threads (DriverConfig::jobs), the output is the same of the serial write */
+	DRIVER_CAP_PARALLEL_WRITE = 1 << 0,
+	/** WriteFile is implemented by the driver (global passes over the file) */
+	DRIVER_CAP_WRITE_FILE = 1 << 1,
+	/** the driver uses the field offsets and the padding of the structure layouts */
+	DRIVER_CAP_LAYOUT = 1 << 2,
+};
+
+/**
+* Bit sizes supported by a driver
+*/
+enum DriverBits : uint32_t
+{
+	/** 16-bit platforms */
+	DRIVER_BITS_16 = 1 << 0,
+	/** 32-bit platforms */
+	DRIVER_BITS_32 = 1 << 1,
+	/** 64-bit platforms */
+	DRIVER_BITS_64 = 1 << 2,
+};
+
+/**
+* Gets the flag of a platform in DriverDescriptor::platforms
+* @param type Platform type
+* @return Platform flag
+*/
+constexpr uint32_t DriverPlatformFlag(PlatformType type) { return 1u << static_cast<uint32_t>(type); }
+
+/**
+* Description of a driver, exported by the driver library so the host can check
+*  the driver before creating it
+*/
+struct DriverDescriptor
+{
+	/** DRIVER_ABI_VERSION of the driver */
+	uint32_t abi_version;
+	/** name of the driver */
+	const char* name;
+	/** version of the driver */
+	const char* version;
+	/** author of the driver */
+	const char* author;
+	/** capabilities of the driver (DriverCaps) */
+	uint32_t caps;
+	/** supported platforms (DriverPlatformFlag), 0 if every platform is supported */
+	uint32_t platforms;
+	/** supported bit sizes (DriverBits), 0 if every size is supported */
+	uint32_t bits;
+	/** creates the driver */
+	DriverEntrypointFunc create;
+
+	/**
+	* Checks if the driver has a capability
+	* @param cap Capability to check
+	* @return true if the driver has the capability
+	*/
+	constexpr bool Have(DriverCaps cap) const { return (caps & cap) != 0; }
+
+	/**
+	* Checks if the driver can write the files of a platform
+	* @param info Platform to check
+	* @return true if the platform and its bit size are supported
+	*/
+	constexpr bool Supports(const PlatformInfo& info) const
+	{
+		const uint32_t bit = info.GetBits() == 16 ? DRIVER_BITS_16 : info.GetBits() == 32 ? DRIVER_BITS_32 : DRIVER_BITS_64;
+		return (platforms == 0 || (platforms & DriverPlatformFlag(info.GetType())) != 0) && (bits == 0 || (bits & bit) != 0);
+	}
+};
+
+/** callback that returns the descriptor of the driver */
+using DriverDescriptorFunc = const DriverDescriptor*(*)(void);
+
+/** driver descriptor name, exported by the driver libraries */
+#define DRIVER_DESCRIPTOR_NAME "CH2DriverDescriptor"
 
-/** driver entrypoint name */
-#define DRIVER_ENTRYPOINT_NAME "CH2DriverEntrypoint"
+/** helper of DRIVER_BUILTIN_DESCRIPTOR */
+#define DRIVER_BUILTIN_DESCRIPTOR_(id) CH2DriverDescriptor_##id
 
-#ifdef DISABLE_DYNLIB
 /**
-* Entrypoint of the driver
-* @return the driver information
-* @note the caller must manually free the driver pointer
+* Descriptor of a driver built into the application (eg: CH2DriverDescriptor_masm),
+*  see the registry of ch2drvreg
 */
-extern "C" Driver* CH2DriverEntrypoint(void);
-#endif
+#define DRIVER_BUILTIN_DESCRIPTOR(id) DRIVER_BUILTIN_DESCRIPTOR_(id)
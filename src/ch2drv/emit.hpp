@@ -0,0 +1,73 @@
+/**
+* @file emit.hpp
+* @author lakor64
+* @date 18/10/2026
+* @brief member emit loop
+*/
+#pragma once
+
+#include "basicmember.hpp"
+#include "define.hpp"
+#include "enum.hpp"
+#include "function.hpp"
+#include "globalvar.hpp"
+#include "struct.hpp"
+#include "typedef.hpp"
+
+#include <vector>
+
+/**
+* Writes every member with a driver.
+* When D is the concrete (final) driver class the Write* calls are resolved at compile
+*  time, with D = Driver this is the same as calling them through the vtable.
+* @param drv Driver that writes the members
+* @param begin First member to write
+* @param end End of the members to write
+*/
+template <typename D>
+void EmitMembers(D& drv, BasicMember* const* begin, BasicMember* const* end)
+{
+	for (auto it = begin; it != end; ++it)
+	{
+		const auto type = *it;
+
+		// the type id always matches the class of the member
+		switch (type->GetTypeID())
+		{
+		case MemberType::Typedef:
+			drv.WriteTypeDef(*static_cast<const Typedef*>(type));
+			break;
+		case MemberType::Union:
+			drv.WriteUnion(*static_cast<const Union*>(type));
+			break;
+		case MemberType::Struct:
+			drv.WriteStruct(*static_cast<const Struct*>(type));
+			break;
+		case MemberType::Enum:
+			drv.WriteEnum(*static_cast<const Enum*>(type));
+			break;
+		case MemberType::Define:
+			drv.WriteDefine(*static_cast<const Define*>(type));
+			break;
+		case MemberType::GlobalVar:
+			drv.WriteGlobalVar(*static_cast<const GlobalVar*>(type));
+			break;
+		case MemberType::Function:
+			drv.WriteFunction(*static_cast<const Function*>(type));
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+/**
+* Writes every member with a driver
+* @param drv Driver that writes the members
+* @param types Members to write
+*/
+template <typename D>
+void EmitMembers(D& drv, const std::vector<BasicMember*>& types)
+{
+	EmitMembers(drv, types.data(), types.data() + types.size());
+}
@@ -0,0 +1,129 @@
+/**
+* @file outputsink.hpp
+* @author lakor64
+* @date 18/10/2026
+* @brief buffered driver output
+*/
+#pragma once
+
+#include <fmt/format.h>
+
+#include <cstdio>
+#include <string_view>
+
+/**
+* Output of a driver, the text is formatted directly in a growable buffer.
+* When a file is attached the buffer is written to it in large blocks,
+*  otherwise the whole output is kept in memory.
+*/
+class OutputSink final
+{
+public:
+	/** size of the buffer that triggers a write to the file */
+	static constexpr size_t FlushSize = 64 * 1024;
+
+	/**
+	* Default constructor
+	* @param fp File that receives the output or NULL to keep it in memory
+	*/
+	explicit OutputSink(FILE* fp = nullptr) : m_fp(fp), m_flushed(0), m_error(false) {}
+
+	/**
+	* Default deconstructor, the pending output is written to the file
+	*/
+	~OutputSink() { Flush(); }
+
+	OutputSink(const OutputSink&) = delete;
+	OutputSink& operator=(const OutputSink&) = delete;
+
+	/**
+	* Writes a string
+	* @param str String to write
+	*/
+	void Write(std::string_view str)
+	{
+		m_buf.append(str.data(), str.data() + str.size());
+		FlushIfFull();
+	}
+
+	/**
+	* Writes a formatted string
+	* @param fmt String to format
+	* @param args Arguments to format
+	*/
+	template <typename... Args>
+	void Format(std::string_view fmt, Args&&... args)
+	{
+		fmt::vformat_to(fmt::appender(m_buf), fmt, fmt::make_format_args(args...));
+		FlushIfFull();
+	}
+
+	/**
+	* Reserves the buffer for the expected output, a file sink does not reserve more than FlushSize
+	* @param size Expected size of the output
+	*/
+	void Reserve(size_t size)
+	{
+		m_buf.reserve(m_fp && size > FlushSize ? FlushSize : size);
+	}
+
+	/**
+	* Writes the pending output to the file, it does nothing for a memory sink
+	* @return true if the output was written, otherwise false
+	*/
+	bool Flush()
+	{
+		if (!m_fp || m_buf.size() == 0)
+			return !m_error;
+
+		if (fwrite(m_buf.data(), 1, m_buf.size(), m_fp) != m_buf.size())
+			m_error = true;
+
+		m_flushed += m_buf.size();
+		m_buf.clear();
+		return !m_error;
+	}
+
+	/**
+	* Gets the output that was not written to the file yet, for a memory sink this is the whole output
+	* @return Pending output
+	*/
+	std::string_view GetPending() const { return std::string_view(m_buf.data(), m_buf.size()); }
+
+	/**
+	* Gets the total size of the output
+	* @return Bytes written to the sink
+	*/
+	size_t GetSize() const { return m_flushed + m_buf.size(); }
+
+	/**
+	* Gets the attached file
+	* @return File or NULL for a memory sink
+	*/
+	constexpr FILE* GetFile() const { return m_fp; }
+
+	/**
+	* Checks if a write to the file failed
+	* @return true if there was an error
+	*/
+	constexpr bool HaveError() const { return m_error; }
+
+private:
+	/**
+	* Writes the buffer to the file when it's big enough
+	*/
+	void FlushIfFull()
+	{
+		if (m_fp && m_buf.size() >= FlushSize)
+			Flush();
+	}
+
+	/** pending output */
+	fmt::memory_buffer m_buf;
+	/** destination file, can be NULL */
+	FILE* m_fp;
+	/** bytes already written to the file */
+	size_t m_flushed;
+	/** a write to the file failed */
+	bool m_error;
+};
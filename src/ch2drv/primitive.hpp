@@ -56,6 +56,7 @@ enum class PrimitiveMods
 class Primitive final : public BasicMember
 {
 	friend CH2Parser;
+	friend PrimitiveTable;
 public:
 	/**
 	* Default constructor
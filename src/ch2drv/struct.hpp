@@ -7,10 +7,49 @@
 #pragma once
 
 #include "variable.hpp"
+#include <cstdint>
 #include <vector>
 
 class Struct;
 
+/**
+* Type of an entry of a structure layout
+*/
+enum class LayoutEntryType
+{
+	/**
+	* A single field
+	*/
+	Field,
+
+	/**
+	* A group of bitfields that share the same storage unit
+	*/
+	BitGroup,
+
+	/**
+	* Unused space between two entries or at the end of the structure
+	*/
+	Padding,
+};
+
+/**
+* An entry of the layout of a structure
+*/
+struct LayoutEntry
+{
+	/** type of the entry */
+	LayoutEntryType type;
+	/** offset of the entry from the start of the structure in bits, -1 if unknown */
+	int64_t offset;
+	/** size of the entry in bits */
+	int64_t size;
+	/** index of the first field of the entry (the field after the padding for padding entries) */
+	uint32_t first;
+	/** number of fields in the entry (0 for padding) */
+	uint32_t count;
+};
+
 /**
 * A C structure/union field
 */
@@ -21,7 +60,7 @@ public:
 	/**
 	* Default constructor
 	*/
-	explicit StructField() : Variable(), m_parent(nullptr) { m_type = MemberType::StructField; }
+	explicit StructField() : Variable(), m_parent(nullptr), m_offset(-1) { m_type = MemberType::StructField; }
 
 	/**
 	* Gets the parent of this field
@@ -29,9 +68,24 @@ public:
 	*/
 	constexpr const Struct* GetParent() const { return m_parent; }
 
+	/**
+	* Gets the offset of the field
+	* @return Offset from the start of the parent in bits, -1 if it's unknown
+	*/
+	constexpr auto GetOffset() const { return m_offset; }
+
+	/**
+	* Checks if the field is a bitfield
+	* @return true if the field is a bitfield, otherwise false
+	* @note the width of a bitfield is returned by GetSize()
+	*/
+	constexpr bool IsBitField() const { return GetSize() != -1; }
+
 private:
 	/** parent of this field */
 	Struct* m_parent;
+	/** offset of the field in bits */
+	int64_t m_offset;
 };
 
 /**
@@ -75,6 +129,14 @@ public:
 	*/
 	constexpr auto IsUnnamed() const { return m_unnamed; }
 
+	/**
+	* Gets the layout of this structure
+	* @return Fields, bitfield groups and padding sorted by offset
+	* @note for unions every entry starts at offset 0 and no padding is present
+	* @note empty when the driver does not have DRIVER_CAP_LAYOUT
+	*/
+	constexpr const auto& GetLayout() const { return m_layout; }
+
 protected:
 	/** alignment of the structure in bits */
 	int64_t m_align;
@@ -82,6 +144,8 @@ protected:
 	int64_t m_size;
 	/** list of all fields inside the structure */
 	std::vector<StructField*> m_fields;
+	/** layout of the fields */
+	std::vector<LayoutEntry> m_layout;
 	/** if it's an unamed struct */
 	bool m_unnamed;
 };
@@ -0,0 +1,193 @@
+/**
+* @file tracer.cpp
+* @author lakor64
+* @date 18/10/2026
+* @brief Chrome trace-event writer
+*/
+#include "tracer.hpp"
+
+#include <atomic>
+#include <cstdio>
+
+/** ids of the tracers */
+static std::atomic<uint64_t> g_tracer_id(1);
+
+/**
+* Buffer of the current thread for a tracer
+*/
+struct ThreadCache
+{
+	/** id of the tracer that owns the buffer */
+	uint64_t id;
+	/** buffer of the thread */
+	void* buffer;
+};
+
+/** number of tracers cached by each thread */
+static constexpr size_t CacheSize = 4;
+
+static thread_local ThreadCache t_cache[CacheSize] = {};
+static thread_local size_t t_cache_next = 0;
+
+/**
+* Writes a JSON string
+* @param fp Destination file
+* @param str String to write
+*/
+static void write_json_string(FILE* fp, std::string_view str)
+{
+	fputc('"', fp);
+
+	for (const auto c : str)
+	{
+		if (c == '"' || c == '\\')
+		{
+			fputc('\\', fp);
+			fputc(c, fp);
+		}
+		else if (static_cast<unsigned char>(c) < 0x20)
+			fprintf(fp, "\\u%04x", static_cast<unsigned>(c));
+		else
+			fputc(c, fp);
+	}
+
+	fputc('"', fp);
+}
+
+Tracer::Tracer() : m_start(std::chrono::steady_clock::now()), m_id(g_tracer_id++)
+{
+}
+
+Tracer::ThreadBuffer& Tracer::GetBuffer()
+{
+	// the ids are never reused, the entry of a destroyed tracer is never matched
+	for (const auto& c : t_cache)
+	{
+		if (c.id == m_id)
+			return *static_cast<ThreadBuffer*>(c.buffer);
+	}
+
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	const auto thread = std::this_thread::get_id();
+	ThreadBuffer* buf = nullptr;
+
+	// the thread already has a buffer when the entry was evicted from the cache
+	for (const auto& b : m_buffers)
+	{
+		if (b->thread == thread)
+		{
+			buf = b.get();
+			break;
+		}
+	}
+
+	if (!buf)
+	{
+		auto nbuf = std::make_unique<ThreadBuffer>();
+		nbuf->tid = static_cast<uint32_t>(m_buffers.size() + 1);
+		nbuf->thread = thread;
+		nbuf->events.reserve(1024);
+
+		buf = nbuf.get();
+		m_buffers.emplace_back(std::move(nbuf));
+	}
+
+	auto& c = t_cache[t_cache_next];
+	c.id = m_id;
+	c.buffer = buf;
+	t_cache_next = (t_cache_next + 1) % CacheSize;
+
+	return *buf;
+}
+
+void Tracer::Add(char type, const char* name, std::string_view detail)
+{
+	const auto now = std::chrono::steady_clock::now();
+	auto& buf = GetBuffer();
+
+	Event e;
+	e.name = name;
+	e.ts = std::chrono::duration<double, std::micro>(now - m_start).count();
+	e.type = type;
+	e.detail = -1;
+
+	if (!detail.empty())
+	{
+		e.detail = static_cast<int32_t>(buf.strings.size());
+		buf.strings.emplace_back(detail);
+	}
+
+	buf.events.emplace_back(e);
+}
+
+void Tracer::Begin(const char* name, std::string_view detail)
+{
+	Add('B', name, detail);
+}
+
+void Tracer::End()
+{
+	Add('E', "", std::string_view());
+}
+
+void Tracer::Instant(const char* name, std::string_view detail)
+{
+	Add('i', name, detail);
+}
+
+void Tracer::SetThreadName(std::string_view name)
+{
+	GetBuffer().name = name;
+}
+
+bool Tracer::Write(const std::string& path) const
+{
+#ifdef _WIN32
+	FILE* fp = nullptr;
+	fopen_s(&fp, path.c_str(), "wb");
+#else
+	FILE* fp = fopen(path.c_str(), "wb");
+#endif
+
+	if (!fp)
+		return false;
+
+	bool first = true;
+	fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", fp);
+
+	for (const auto& buf : m_buffers)
+	{
+		// track name
+		fprintf(fp, "%s\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", first ? "" : ",", buf->tid);
+		write_json_string(fp, buf->name.empty() ? "thread " + std::to_string(buf->tid) : buf->name);
+		fputs("}}", fp);
+		first = false;
+
+		for (const auto& e : buf->events)
+		{
+			fprintf(fp, ",\n{\"ph\":\"%c\",\"pid\":1,\"tid\":%u,\"ts\":%.3f", e.type, buf->tid, e.ts);
+
+			if (e.type != 'E')
+			{
+				fputs(",\"name\":", fp);
+				write_json_string(fp, e.name);
+			}
+
+			if (e.type == 'i')
+				fputs(",\"s\":\"t\"", fp);
+
+			if (e.detail >= 0)
+			{
+				fputs(",\"args\":{\"detail\":", fp);
+				write_json_string(fp, buf->strings[e.detail]);
+				fputc('}', fp);
+			}
+
+			fputc('}', fp);
+		}
+	}
+
+	fputs("\n]}\n", fp);
+	return fclose(fp) == 0;
+}
@@ -0,0 +1,118 @@
+/**
+* @file tracer.hpp
+* @author lakor64
+* @date 18/10/2026
+* @brief Chrome trace-event writer
+*/
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/**
+* Records spans and instant events into a Chrome/Perfetto trace-event file.
+* Every thread writes into its own buffer, the only lock is taken the first time
+*  a thread records an event. The trace must be written once all the threads stopped recording.
+*/
+class Tracer final
+{
+public:
+	/**
+	* Default constructor
+	*/
+	explicit Tracer();
+
+	/**
+	* Starts a span on the current thread
+	* @param name Name of the span, this must be a static string
+	* @param detail Optional detail of the span (eg: the header name)
+	*/
+	void Begin(const char* name, std::string_view detail = std::string_view());
+
+	/**
+	* Ends the last span started on the current thread
+	*/
+	void End();
+
+	/**
+	* Records an instant event on the current thread
+	* @param name Name of the event, this must be a static string
+	* @param detail Optional detail of the event
+	*/
+	void Instant(const char* name, std::string_view detail = std::string_view());
+
+	/**
+	* Names the track of the current thread
+	* @param name Name of the track (eg: "worker 1")
+	*/
+	void SetThreadName(std::string_view name);
+
+	/**
+	* Writes the trace
+	* @param path Destination file
+	* @return true if the file was written, otherwise false
+	*/
+	bool Write(const std::string& path) const;
+
+private:
+	/**
+	* A single event
+	*/
+	struct Event
+	{
+		/** event name */
+		const char* name;
+		/** time in microseconds since the tracer creation */
+		double ts;
+		/** type of the event ('B', 'E' or 'i') */
+		char type;
+		/** index of the detail inside the thread strings, -1 if there's no detail */
+		int32_t detail;
+	};
+
+	/**
+	* Events of a single thread
+	*/
+	struct ThreadBuffer
+	{
+		/** id of the track */
+		uint32_t tid;
+		/** thread that owns the buffer */
+		std::thread::id thread;
+		/** name of the track */
+		std::string name;
+		/** recorded events */
+		std::vector<Event> events;
+		/** details of the events */
+		std::vector<std::string> strings;
+	};
+
+	/**
+	* Gets the buffer of the current thread, it's created the first time
+	* @return Buffer of the thread
+	*/
+	ThreadBuffer& GetBuffer();
+
+	/**
+	* Adds an event to the current thread
+	* @param type Event type
+	* @param name Event name
+	* @param detail Event detail
+	*/
+	void Add(char type, const char* name, std::string_view detail);
+
+	/** start of the trace */
+	std::chrono::steady_clock::time_point m_start;
+	/** protects the registration of the thread buffers */
+	std::mutex m_lock;
+	/** buffers of all the threads */
+	std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+	/** unique id of the tracer, used to find the thread buffers */
+	uint64_t m_id;
+};
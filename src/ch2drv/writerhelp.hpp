@@ -6,28 +6,29 @@
 */
 #pragma once
 
-#include <fmt/format.h>
+#include "outputsink.hpp"
+
 #include <string_view>
+#include <utility>
 
 /**
-* Writes a string to a C file
-* @param fp C file pointer
+* Writes a string to the driver output
+* @param out Output sink
 * @param fmt String to write
 */
-static void writefmt(FILE* fp, const std::string_view& fmt)
+static void writefmt(OutputSink& out, const std::string_view& fmt)
 {
-	fwrite(fmt.data(), fmt.size(), 1, fp);
+	out.Write(fmt);
 }
 
 /**
-* Writes a formatted string to a C file
-* @param fp C file pointer
+* Writes a formatted string to the driver output, the text is formatted in the sink buffer
+* @param out Output sink
 * @param fmt String to format
 * @param args Arguments to format
 */
 template <typename... Args>
-static void writefmt(FILE* fp, const std::string_view& fmt, Args&&... args)
+static void writefmt(OutputSink& out, const std::string_view& fmt, Args&&... args)
 {
-	auto f = fmt::vformat(fmt, fmt::make_format_args(args...));
-	writefmt(fp, f);
+	out.Format(fmt, std::forward<Args>(args)...);
 }
@@ -0,0 +1,36 @@
+/**
+* @file driverregistry.hpp
+* @author lakor64
+* @date 18/10/2026
+* @brief registry of the built-in drivers
+*/
+#pragma once
+
+#include <driver.hpp>
+
+#include <string>
+
+/**
+* Driver built into the application
+*/
+struct BuiltinDriver
+{
+	/** name used to select the driver (eg: masm) */
+	const char* name;
+	/** descriptor of the driver */
+	DriverDescriptorFunc descriptor;
+};
+
+/**
+* Gets the built-in drivers
+* @param count Number of drivers
+* @return Array of the drivers
+*/
+const BuiltinDriver* GetBuiltinDrivers(size_t& count);
+
+/**
+* Finds a built-in driver
+* @param name Name of the driver
+* @return Descriptor of the driver or NULL if no built-in driver has this name
+*/
+const DriverDescriptor* FindBuiltinDriver(const std::string& name);
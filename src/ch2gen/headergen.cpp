@@ -0,0 +1,188 @@
+/**
+* @file headergen.cpp
+* @author lakor64
+* @date 18/10/2026
+* @brief synthetic C header generator
+*/
+#include "headergen.hpp"
+
+#include <sstream>
+
+/** field types, they are picked in order */
+static constexpr const char* g_field_types[] = { "int", "char", "short", "long", "unsigned int", "double", "void*", "float", "long long", "unsigned char" };
+
+/** number of field types */
+static constexpr uint32_t g_field_type_count = static_cast<uint32_t>(sizeof(g_field_types) / sizeof(g_field_types[0]));
+
+bool HeaderGenConfig::GetPreset(const std::string& name, HeaderGenConfig& cfg)
+{
+	cfg = HeaderGenConfig();
+
+	if (name == "small")
+	{
+		cfg.structs = 100;
+		cfg.fields = 8;
+		cfg.depth = 1;
+		cfg.unions = 10;
+		cfg.bitfields = 2;
+		cfg.enums = 20;
+		cfg.enum_constants = 16;
+		cfg.macros = 50;
+		cfg.macro_chain = 4;
+		cfg.functions = 100;
+		cfg.callbacks = 10;
+	}
+	else if (name == "large")
+	{
+		cfg.structs = 1000;
+		cfg.fields = 8;
+		cfg.depth = 1;
+		cfg.unions = 100;
+		cfg.bitfields = 2;
+		cfg.enums = 200;
+		cfg.enum_constants = 16;
+		cfg.macros = 500;
+		cfg.macro_chain = 4;
+		cfg.functions = 1000;
+		cfg.callbacks = 100;
+	}
+	else if (name == "windows")
+	{
+		// roughly the declarations that windows.h brings in with the default defines
+		cfg.structs = 4000;
+		cfg.fields = 8;
+		cfg.depth = 1;
+		cfg.unions = 400;
+		cfg.bitfields = 1;
+		cfg.enums = 600;
+		cfg.enum_constants = 12;
+		cfg.macros = 6000;
+		cfg.macro_chain = 4;
+		cfg.functions = 12000;
+		cfg.callbacks = 600;
+	}
+	else
+		return false;
+
+	return true;
+}
+
+void HeaderGen::Write(std::ostream& os) const
+{
+	os << "/* generated by ch2gen */\n#pragma once\n\n";
+
+	WriteMacros(os);
+	WriteEnums(os);
+	WriteCallbacks(os);
+	WriteUnions(os);
+	WriteStructs(os);
+	WriteFunctions(os);
+}
+
+std::string HeaderGen::ToString() const
+{
+	std::ostringstream os;
+	Write(os);
+	return os.str();
+}
+
+void HeaderGen::WriteMacros(std::ostream& os) const
+{
+	for (uint32_t i = 0; i < m_cfg.macros; i++)
+	{
+		os << "#define M" << i << "_0 " << (i + 1) << "\n";
+
+		// every link references the previous one
+		for (uint32_t k = 1; k < m_cfg.macro_chain; k++)
+			os << "#define M" << i << "_" << k << " (M" << i << "_" << (k - 1) << " * 2 + " << k << ")\n";
+	}
+
+	if (m_cfg.macros > 0)
+		os << "\n";
+}
+
+void HeaderGen::WriteEnums(std::ostream& os) const
+{
+	for (uint32_t i = 0; i < m_cfg.enums; i++)
+	{
+		os << "enum E" << i << " {";
+
+		for (uint32_t k = 0; k < m_cfg.enum_constants; k++)
+			os << (k > 0 ? ", " : " ") << "E" << i << "_" << k << " = " << k;
+
+		os << " };\n";
+	}
+}
+
+void HeaderGen::WriteCallbacks(std::ostream& os) const
+{
+	for (uint32_t i = 0; i < m_cfg.callbacks; i++)
+		os << "typedef int (*CB" << i << ")(int code, void* ctx, unsigned long size);\n";
+}
+
+void HeaderGen::WriteUnions(std::ostream& os) const
+{
+	for (uint32_t i = 0; i < m_cfg.unions; i++)
+	{
+		os << "typedef union U" << i << " {";
+
+		for (uint32_t k = 0; k < m_cfg.fields; k++)
+			os << " " << g_field_types[(i + k) % g_field_type_count] << " f" << k << ";";
+
+		os << " } U" << i << ";\n";
+	}
+}
+
+void HeaderGen::WriteNested(std::ostream& os, const std::string& name, uint32_t level) const
+{
+	if (level > m_cfg.depth)
+		return;
+
+	os << " struct " << name << "_n" << level << " { int v" << level << ";";
+	WriteNested(os, name, level + 1);
+	os << " } n" << level << ";";
+}
+
+void HeaderGen::WriteStructs(std::ostream& os) const
+{
+	for (uint32_t i = 0; i < m_cfg.structs; i++)
+	{
+		const auto name = "S" + std::to_string(i);
+		os << "typedef struct " << name << " {";
+
+		for (uint32_t k = 0; k < m_cfg.fields; k++)
+			os << " " << g_field_types[(i + k) % g_field_type_count] << " f" << k << ";";
+
+		for (uint32_t k = 0; k < m_cfg.bitfields; k++)
+			os << " unsigned int b" << k << " : " << (k % 7 + 1) << ";";
+
+		// references to the previous structures, by value and by pointer
+		if (i > 0)
+			os << " struct S" << (i - 1) << " prev; struct S" << (i / 2) << "* half;";
+
+		if (m_cfg.unions > 0)
+			os << " U" << (i % m_cfg.unions) << " u;";
+
+		if (m_cfg.callbacks > 0)
+			os << " CB" << (i % m_cfg.callbacks) << " cb;";
+
+		WriteNested(os, name, 1);
+		os << " } " << name << ", *P" << name << ";\n";
+	}
+}
+
+void HeaderGen::WriteFunctions(std::ostream& os) const
+{
+	for (uint32_t i = 0; i < m_cfg.functions; i++)
+	{
+		os << "int F" << i << "(int a, const char* b";
+
+		if (m_cfg.structs > 0)
+			os << ", PS" << (i % m_cfg.structs) << " c";
+
+		if (m_cfg.callbacks > 0)
+			os << ", CB" << (i % m_cfg.callbacks) << " d";
+
+		os << ");\n";
+	}
+}
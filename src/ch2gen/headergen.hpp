@@ -0,0 +1,121 @@
+/**
+* @file headergen.hpp
+* @author lakor64
+* @date 18/10/2026
+* @brief synthetic C header generator
+*/
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+/**
+* Shape of a synthetic header
+*/
+struct HeaderGenConfig
+{
+	/** number of structures */
+	uint32_t structs = 0;
+	/** fields of every structure */
+	uint32_t fields = 0;
+	/** depth of the nested structures of every structure */
+	uint32_t depth = 0;
+	/** number of unions */
+	uint32_t unions = 0;
+	/** bitfields of every structure */
+	uint32_t bitfields = 0;
+	/** number of enumerations */
+	uint32_t enums = 0;
+	/** constants of every enumeration */
+	uint32_t enum_constants = 0;
+	/** number of preprocessor definition chains */
+	uint32_t macros = 0;
+	/** length of every chain */
+	uint32_t macro_chain = 0;
+	/** number of function prototypes */
+	uint32_t functions = 0;
+	/** number of callback types, they are used by the structures and the functions */
+	uint32_t callbacks = 0;
+
+	/**
+	* Gets a preset
+	* @param name Name of the preset: small, large or windows (about the size of windows.h)
+	* @param cfg Destination config
+	* @return true if the preset exists, otherwise false
+	*/
+	static bool GetPreset(const std::string& name, HeaderGenConfig& cfg);
+};
+
+/**
+* Generates C headers, the same config always generates the same header
+*/
+class HeaderGen final
+{
+public:
+	/**
+	* Default constructor
+	* @param cfg Shape of the header
+	*/
+	explicit HeaderGen(const HeaderGenConfig& cfg) : m_cfg(cfg) {}
+
+	/**
+	* Writes the header
+	* @param os Destination stream
+	*/
+	void Write(std::ostream& os) const;
+
+	/**
+	* Writes the header to a string
+	* @return Text of the header
+	*/
+	std::string ToString() const;
+
+private:
+	/**
+	* Writes the preprocessor definition chains
+	* @param os Destination stream
+	*/
+	void WriteMacros(std::ostream& os) const;
+
+	/**
+	* Writes the enumerations
+	* @param os Destination stream
+	*/
+	void WriteEnums(std::ostream& os) const;
+
+	/**
+	* Writes the callback types
+	* @param os Destination stream
+	*/
+	void WriteCallbacks(std::ostream& os) const;
+
+	/**
+	* Writes the unions
+	* @param os Destination stream
+	*/
+	void WriteUnions(std::ostream& os) const;
+
+	/**
+	* Writes the structures
+	* @param os Destination stream
+	*/
+	void WriteStructs(std::ostream& os) const;
+
+	/**
+	* Writes the nested structures of a structure
+	* @param os Destination stream
+	* @param name Name of the outer structure
+	* @param level Current nesting level
+	*/
+	void WriteNested(std::ostream& os, const std::string& name, uint32_t level) const;
+
+	/**
+	* Writes the function prototypes
+	* @param os Destination stream
+	*/
+	void WriteFunctions(std::ostream& os) const;
+
+	/** shape of the header */
+	HeaderGenConfig m_cfg;
+};
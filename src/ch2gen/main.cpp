@@ -0,0 +1,106 @@
+/**
+* @file main.cpp
+* @author lakor64
+* @date 18/10/2026
+* @brief synthetic C header generator
+*/
+#include "headergen.hpp"
+
+#include <cxxopts.hpp>
+
+#include <fstream>
+#include <iostream>
+
+/**
+* Main entrypoint of the generator
+* @param argc Number of arguments
+* @param argv Arguments pointer
+* @return exit code
+*/
+int main(int argc, char** argv)
+{
+	cxxopts::Options opt("ch2gen", "Synthetic C header generator");
+	opt.add_options()
+		("h,help", "Show this help screen")
+		("preset", "Start from a preset: small, large or windows", cxxopts::value<std::string>())
+		("structs", "Number of structures", cxxopts::value<uint32_t>())
+		("fields", "Fields of every structure and union", cxxopts::value<uint32_t>())
+		("depth", "Depth of the nested structures", cxxopts::value<uint32_t>())
+		("unions", "Number of unions", cxxopts::value<uint32_t>())
+		("bitfields", "Bitfields of every structure", cxxopts::value<uint32_t>())
+		("enums", "Number of enumerations", cxxopts::value<uint32_t>())
+		("enum-constants", "Constants of every enumeration", cxxopts::value<uint32_t>())
+		("macros", "Number of macro chains", cxxopts::value<uint32_t>())
+		("macro-chain", "Length of every macro chain", cxxopts::value<uint32_t>())
+		("functions", "Number of function prototypes", cxxopts::value<uint32_t>())
+		("callbacks", "Number of callback types", cxxopts::value<uint32_t>())
+		("output", "The output file (standard output if not specified)", cxxopts::value<std::string>())
+		;
+
+	opt.parse_positional({ "output" });
+
+	cxxopts::ParseResult res;
+
+	try
+	{
+		res = opt.parse(argc, argv);
+	}
+	catch (std::exception& e)
+	{
+		std::cerr << e.what() << std::endl;
+		return -1;
+	}
+
+	if (res.count("help"))
+	{
+		std::cout << opt.help() << std::endl;
+		return 0;
+	}
+
+	HeaderGenConfig cfg;
+
+	if (res.count("preset") && !HeaderGenConfig::GetPreset(res["preset"].as<std::string>(), cfg))
+	{
+		std::cerr << "Invalid preset" << std::endl;
+		return -1;
+	}
+
+	const std::pair<const char*, uint32_t*> values[] = {
+		{ "structs", &cfg.structs },
+		{ "fields", &cfg.fields },
+		{ "depth", &cfg.depth },
+		{ "unions", &cfg.unions },
+		{ "bitfields", &cfg.bitfields },
+		{ "enums", &cfg.enums },
+		{ "enum-constants", &cfg.enum_constants },
+		{ "macros", &cfg.macros },
+		{ "macro-chain", &cfg.macro_chain },
+		{ "functions", &cfg.functions },
+		{ "callbacks", &cfg.callbacks },
+	};
+
+	for (const auto& v : values)
+	{
+		if (res.count(v.first))
+			*v.second = res[v.first].as<uint32_t>();
+	}
+
+	HeaderGen gen(cfg);
+
+	if (!res.count("output"))
+	{
+		gen.Write(std::cout);
+		return 0;
+	}
+
+	std::ofstream ofs(res["output"].as<std::string>(), std::ios::binary);
+
+	if (!ofs)
+	{
+		std::cerr << "Unable to open output file" << std::endl;
+		return -2;
+	}
+
+	gen.Write(ofs);
+	return ofs ? 0 : -2;
+}
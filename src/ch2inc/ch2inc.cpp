@@ -7,16 +7,78 @@
 #include "ch2inc.hpp"
 #include "clangcli.hpp"
 
+#include <driverregistry.hpp>
+#include <stats.hpp>
+
+#ifdef CH2_DRIVER_HEADER
+#include CH2_DRIVER_HEADER
+#endif
+
+#include <algorithm>
 #include <iostream>
 #include <filesystem>
+#include <thread>
+
+/**
+* Gets the driver used when -d is not specified
+* @return Name of the first built-in driver or NULL if no driver is built in
+*/
+static const char* get_default_driver()
+{
+	size_t count = 0;
+	const auto builtin = GetBuiltinDrivers(count);
+
+	return count > 0 ? builtin[0].name : nullptr;
+}
+
+#ifdef CH2_ENABLE_STATS
+/**
+* Counts the driver calls of the members
+* @param types Members that are written
+*/
+static void count_driver_calls(const std::vector<BasicMember*>& types)
+{
+	for (const auto type : types)
+	{
+		switch (type->GetTypeID())
+		{
+		case MemberType::Typedef:
+			CH2_STAT(DriverTypedef);
+			break;
+		case MemberType::Union:
+			CH2_STAT(DriverUnion);
+			break;
+		case MemberType::Struct:
+			CH2_STAT(DriverStruct);
+			break;
+		case MemberType::Enum:
+			CH2_STAT(DriverEnum);
+			break;
+		case MemberType::Define:
+			CH2_STAT(DriverDefine);
+			break;
+		case MemberType::GlobalVar:
+			CH2_STAT(DriverGlobalVar);
+			break;
+		case MemberType::Function:
+			CH2_STAT(DriverFunction);
+			break;
+		default:
+			break;
+		}
+	}
+}
+#endif
 
 CH2Inc::CH2Inc()
 	: m_opt("ch2inc", "C include to ASM include generator")
 	, m_parser()
 	, m_file()
+	, m_profiler()
+	, m_tracer()
 	, m_sopts()
 	, m_fp(nullptr)
-	, m_drvep(nullptr)
+	, m_drvdesc(nullptr)
 	, m_drvfnc(nullptr)
 #ifndef DISABLE_DYNLIB
 	, m_drv(nullptr)
@@ -30,13 +92,24 @@ CH2Inc::CH2Inc()
 		("h,help", "Show this help screen")
 		("p,platform", "Platform to build", cxxopts::value<std::string>())
 		("b,platform-bitsize", "Bits size of the platform", cxxopts::value<unsigned int>())
-		("d,driver", "Driver to use", cxxopts::value<std::string>())
+		("d,driver", "Driver to use: the name of a built-in driver or a driver library (default: the first built-in driver)", cxxopts::value<std::string>())
 		("nologo", "Do not print the startup info")
 		("msvc", "Run the tool in MSVC compatibility mode")
 		("input", "The input file to process", cxxopts::value<std::string>())
 		("output", "The output file to result", cxxopts::value<std::string>())
 		("verbose", "Enable verbose logging")
-		("only-int-macros", "Ignore all macros except the integer ones (this emulates the behavour of H2INC)")
+		("only-int-macros", "Ignore all macros except the integer ones (this emulates the behavour of H2INC), same as --macros=int")
+		("macros", "Macros to write: all, int or none", cxxopts::value<std::string>())
+		("no-functions", "Do not write the function declarations")
+		("no-globals", "Do not write the global variables")
+		("no-enums", "Do not write the enumerations (the enumeration types are written as their integer type)")
+		("time-report", "Print the wall and CPU time, the hardware counters (Linux only) of each phase and the memory used: text or json", cxxopts::value<std::string>()->implicit_value("text"))
+		("trace", "Write a Chrome trace-event file of the phases", cxxopts::value<std::string>())
+		("stats", "Print the internal statistics counters: text or json", cxxopts::value<std::string>()->implicit_value("text"))
+		("macro-refs", "Write integer macros as expressions of the macros they reference instead of the computed value")
+		("probe-macros", "Evaluate the macros that use sizeof, casts or enum constants with an extra parse")
+		("fast", "Fast parse for self-contained headers, the includes are not processed (falls back to the full parse on errors)")
+		("j,jobs", "Number of threads used to write the output when the driver supports it (0 uses every core)", cxxopts::value<unsigned int>())
 		;
 
 	m_opt.parse_positional({ "input", "output" });
@@ -71,6 +144,18 @@ void CH2Inc::ShowHelp()
 		"  16\t\t\tTargets a 8086 architecture (does not work for MacOS or Linux)" << std::endl <<
 		"  32\t\t\tTargets a x86 architecture" << std::endl <<
 		"  64\t\t\tTargets a x86_64 architecture (does not work for DOS)" << std::endl;
+
+	size_t count = 0;
+	const auto builtin = GetBuiltinDrivers(count);
+
+	std::cout << std::endl << "Built-in drivers:" << std::endl;
+
+	for (size_t i = 0; i < count; i++)
+		std::cout << "  " << builtin[i].name << "\t\t\t" << builtin[i].descriptor()->name << std::endl;
+
+#ifndef DISABLE_DYNLIB
+	std::cout << "  (any other name is loaded as a driver library)" << std::endl;
+#endif
 }
 
 int CH2Inc::ParseCli(int argc, char** argv)
@@ -90,9 +175,7 @@ int CH2Inc::ParseCli(int argc, char** argv)
 		|| !res.count("input")
 		|| !res.count("platform") 
 		|| !res.count("platform-bitsize")
-#ifndef DISABLE_DYNLIB
-		|| !res.count("d")
-#endif
+		|| (!res.count("d") && !get_default_driver())
 	)
 	{
 		return -1;
@@ -108,7 +191,71 @@ int CH2Inc::ParseCli(int argc, char** argv)
 		m_sopts.msvc = true;
 
 	if (res.count("only-int-macros"))
-		m_sopts.macro_like_h2inc = true;
+		m_sopts.macros = MacroFilter::Int;
+
+	if (res.count("macros"))
+	{
+		const auto& macros = res["macros"].as<std::string>();
+
+		if (macros == "all")
+			m_sopts.macros = MacroFilter::All;
+		else if (macros == "int")
+			m_sopts.macros = MacroFilter::Int;
+		else if (macros == "none")
+			m_sopts.macros = MacroFilter::None;
+		else
+			return -1;
+	}
+
+	if (res.count("no-functions"))
+		m_sopts.functions = false;
+
+	if (res.count("no-globals"))
+		m_sopts.globals = false;
+
+	if (res.count("no-enums"))
+		m_sopts.enums = false;
+
+	if (res.count("time-report"))
+	{
+		m_sopts.time_report = res["time-report"].as<std::string>();
+
+		if (m_sopts.time_report != "text" && m_sopts.time_report != "json")
+			return -1;
+	}
+
+	if (res.count("trace"))
+		m_sopts.trace = res["trace"].as<std::string>();
+
+	if (res.count("stats"))
+	{
+		m_sopts.stats = res["stats"].as<std::string>();
+
+		if (m_sopts.stats != "text" && m_sopts.stats != "json")
+			return -1;
+
+#ifndef CH2_ENABLE_STATS
+		std::cout << "Statistics are disabled in this build!" << std::endl;
+		m_sopts.stats.clear();
+#endif
+	}
+
+	if (res.count("macro-refs"))
+		m_sopts.macro_refs = true;
+
+	if (res.count("probe-macros"))
+		m_sopts.probe_macros = true;
+
+	if (res.count("fast"))
+		m_sopts.fast = true;
+
+	if (res.count("jobs"))
+	{
+		m_sopts.jobs = res["jobs"].as<unsigned int>();
+
+		if (m_sopts.jobs == 0)
+			m_sopts.jobs = std::max(1u, std::thread::hardware_concurrency());
+	}
 
 	auto platformBits = res["platform-bitsize"].as<unsigned int>();
 	auto platformName = res["platform"].as<std::string>();
@@ -144,13 +291,10 @@ int CH2Inc::ParseCli(int argc, char** argv)
 	if (res.count("undefine"))
 		m_sopts.undef = res["undefine"].as<std::vector<std::string>>();
 
-
-#ifndef DISABLE_DYNLIB
-	m_sopts.driver = res["d"].as<std::string>();
-#else
 	if (res.count("d"))
-		std::cout << "Drivers are disabled in this build!" << std::endl;
-#endif
+		m_sopts.driver = res["d"].as<std::string>();
+	else
+		m_sopts.driver = get_default_driver();
 
 	return 0;
 }
@@ -279,33 +423,154 @@ void CH2Inc::AddDefaultData()
 
 bool CH2Inc::SetupDriver()
 {
+	// the built-in drivers do not need to load a library
+	m_drvdesc = FindBuiltinDriver(m_sopts.driver);
+
+	if (!m_drvdesc)
+	{
 #ifdef DISABLE_DYNLIB
-	m_drvep = (DriverEntrypointFunc)DRIVER_ENTRYPOINT;
+		std::cerr << "The driver " << m_sopts.driver << " is not built in and drivers cannot be loaded in this build" << std::endl;
+		return false;
 #else
-	m_drv = dynlib_load(m_sopts.driver.c_str());
-	if (!m_drv)
+		m_drv = dynlib_load(m_sopts.driver.c_str());
+		if (!m_drv)
+		{
+			std::cerr << "The driver " << m_sopts.driver << " is not built in and the library cannot be loaded" << std::endl;
+			return false;
+		}
+
+		const auto descfnc = (DriverDescriptorFunc)dynlib_getfunc(m_drv, DRIVER_DESCRIPTOR_NAME);
+		if (!descfnc)
+		{
+			std::cerr << "The driver does not export " << DRIVER_DESCRIPTOR_NAME << ", it was built for an older version of ch2inc" << std::endl;
+			return false;
+		}
+
+		m_drvdesc = descfnc();
+#endif
+	}
+
+	if (!m_drvdesc || !m_drvdesc->create)
 		return false;
 
-	m_drvep = (DriverEntrypointFunc)dynlib_getfunc(m_drv, DRIVER_ENTRYPOINT_NAME);
-	if (!m_drvep)
+	// the driver is checked before it's created, an incompatible driver would fail while writing
+	if (m_drvdesc->abi_version != DRIVER_ABI_VERSION)
 	{
-		dynlib_free(m_drv);
+		std::cerr << "The driver uses the interface version " << m_drvdesc->abi_version << ", ch2inc uses the version " << DRIVER_ABI_VERSION << std::endl;
+		return false;
+	}
+
+	if (!m_drvdesc->Supports(m_sopts.info))
+	{
+		std::cerr << "The driver " << m_drvdesc->name << " does not support the selected platform" << std::endl;
 		return false;
 	}
-#endif
 
-	m_drvfnc = m_drvep();
+	m_drvfnc = m_drvdesc->create();
+
+	return m_drvfnc != nullptr;
+}
+
+int CH2Inc::Convert(const ClangCli& clcli, Profiler* profiler)
+{
+	m_parser.Visit(m_sopts.input, clcli.argc, (const char**)clcli.argv, m_file, m_sopts.info);
 
-	if (!m_drvfnc)
+	if (m_parser.GetLastError() != CH2ErrorCodes::None)
 	{
-#ifndef DISABLE_DYNLIB
-		dynlib_free(m_drv);
+		std::cerr << "Error during parsing: " << CH2ErrorCodeStr(m_parser.GetLastError()) << std::endl;
+		return -4;
+	}
+
+	if (m_sopts.verbose)
+		std::cout << "Parsing success! Start writing..." << std::endl;
+
+#ifdef _WIN32
+	fopen_s(&m_fp, m_sopts.output.c_str(), "wb");
+#else
+	m_fp = fopen(m_sopts.output.c_str(), "wb");
 #endif
-		return false;
+
+	if (!m_fp)
+	{
+		std::cerr << "Unable to open output file" << std::endl;
+		return -5;
 	}
 
-	return true;
+	ProfileScope emit(profiler, ProfilePhase::Emit);
+	OutputSink sink(m_fp);
+
+	DriverConfig drvcfg;
+	drvcfg.fp = m_fp;
+	drvcfg.out = &sink;
+	drvcfg.platform = m_sopts.info;
+	drvcfg.verbose = m_sopts.verbose;
+	drvcfg.define_refs = m_sopts.macro_refs;
+	drvcfg.tracer = profiler ? profiler->GetTracer() : nullptr;
+
+	if (m_drvdesc->Have(DRIVER_CAP_PARALLEL_WRITE))
+		drvcfg.jobs = m_sopts.jobs;
+	else if (m_sopts.jobs > 1 && m_sopts.verbose)
+		std::cout << "The driver does not support the parallel write, the output is written on a single thread" << std::endl;
+
+	m_drvfnc->SetConfig(drvcfg);
+
+	std::vector<std::string> mc;
+	mc.push_back("This file was generated by CH2Inc on " + std::string(__TIMESTAMP__) + "\n");
+	mc.push_back("Plaese modify the file\"" + m_sopts.input + "\" insted.\n");
+	m_drvfnc->WriteMultiComment(mc);
+
+	m_drvfnc->WriteFileStart();
+
+#ifdef CH2_ENABLE_STATS
+	count_driver_calls(m_file.GetTypes());
+#endif
 
+#ifdef CH2_DRIVER_CLASS
+	// the driver of a static build is known, the call is resolved at compile time
+	static_cast<CH2_DRIVER_CLASS*>(m_drvfnc)->WriteFile(m_file);
+#else
+	m_drvfnc->WriteFile(m_file);
+#endif
+
+	m_drvfnc->WriteFileEnd();
+
+	const auto written = sink.Flush();
+	CH2_STAT_ADD(BytesWritten, sink.GetSize());
+
+	fclose(m_fp);
+	m_fp = nullptr;
+
+	if (!written)
+	{
+		std::cerr << "Unable to write output file" << std::endl;
+		return -5;
+	}
+
+	return 0;
+}
+
+void CH2Inc::WriteReports()
+{
+	if (!m_sopts.time_report.empty())
+	{
+		if (m_sopts.time_report == "json")
+			m_profiler.WriteJson(std::cout);
+		else
+			m_profiler.WriteText(std::cout);
+	}
+
+	if (m_sopts.stats == "json")
+		Stats::Get().WriteJson(std::cout);
+	else if (m_sopts.stats == "text")
+		Stats::Get().WriteText(std::cout);
+
+	if (!m_sopts.trace.empty())
+	{
+		m_tracer.End();
+
+		if (!m_tracer.Write(m_sopts.trace))
+			std::cerr << "Unable to write the trace file" << std::endl;
+	}
 }
 
 int CH2Inc::Run(int argc, char** argv)
@@ -350,87 +615,35 @@ int CH2Inc::Run(int argc, char** argv)
 		std::cout << std::endl;
 	}
 
-	m_parser.Visit(m_sopts.input, clcli.argc, (const char**)clcli.argv, m_file, m_sopts.info);
+	ParserConfig parsecfg;
+	parsecfg.probe_macros = m_sopts.probe_macros;
+	parsecfg.fast = m_sopts.fast;
+	parsecfg.macros = m_sopts.macros;
+	parsecfg.functions = m_sopts.functions;
+	parsecfg.globals = m_sopts.globals;
+	parsecfg.enums = m_sopts.enums;
+	parsecfg.layout = m_drvdesc->Have(DRIVER_CAP_LAYOUT);
+	m_parser.SetConfig(parsecfg);
 
-	if (m_parser.GetLastError() != CH2ErrorCodes::None)
-	{
-		std::cerr << "Error during parsing: " << CH2ErrorCodeStr(m_parser.GetLastError()) << std::endl;
-		return -4;
-	}
+	auto profiler = m_sopts.time_report.empty() && m_sopts.trace.empty() ? nullptr : &m_profiler;
+	m_parser.SetProfiler(profiler);
 
-	if (m_sopts.verbose)
-		std::cout << "Parsing success! Start writing..." << std::endl;
-
-#ifdef _WIN32
-	fopen_s(&m_fp, m_sopts.output.c_str(), "wb");
-#else
-	m_fp = fopen(m_sopts.output.c_str(), "wb");
-#endif
-
-	if (!m_fp)
-	{
-		std::cerr << "Unable to open output file" << std::endl;
-		return -5;
-	}
-
-	DriverConfig drvcfg;
-	drvcfg.fp = m_fp;
-	drvcfg.platform = m_sopts.info;
-	drvcfg.verbose = m_sopts.verbose;
-	m_drvfnc->SetConfig(drvcfg);
-
-	std::vector<std::string> mc;
-	mc.push_back("This file was generated by CH2Inc on " + std::string(__TIMESTAMP__) + "\n");
-	mc.push_back("Plaese modify the file\"" + m_sopts.input + "\" insted.\n");
-	m_drvfnc->WriteMultiComment(mc);
-
-	m_drvfnc->WriteFileStart();
+	if (!m_sopts.time_report.empty())
+		m_profiler.EnableHardwareCounters();
 
-	for (const auto& type : m_file.GetTypes())
+	if (!m_sopts.trace.empty())
 	{
-		switch (type->GetTypeID())
-		{
-		case MemberType::Typedef:
-			m_drvfnc->WriteTypeDef(*dynamic_cast<const Typedef*>(type));
-			break;
-		case MemberType::Union:
-			m_drvfnc->WriteUnion(*dynamic_cast<const Union*>(type));
-			break;
-		case MemberType::Struct:
-			m_drvfnc->WriteStruct(*dynamic_cast<const Struct*>(type));
-			break;
-		case MemberType::Enum:
-			m_drvfnc->WriteEnum(*dynamic_cast<const Enum*>(type));
-			break;
-		case MemberType::Define:
-		{
-			const auto& def = *dynamic_cast<const Define*>(type);
-
-			if (m_sopts.macro_like_h2inc)
-			{
-				if (def.GetDefineType() != DefineType::Integer 
-					&& def.GetDefineType() != DefineType::Hexadecimal
-					&& def.GetDefineType() != DefineType::Octal)
-					continue;
-			}
-			m_drvfnc->WriteDefine(def);
-			break;
-		}
-		case MemberType::GlobalVar:
-			m_drvfnc->WriteGlobalVar(*dynamic_cast<const GlobalVar*>(type));
-			break;
-		case MemberType::Function:
-			m_drvfnc->WriteFunction(*dynamic_cast<const Function*>(type));
-			break;
-		default:
-			break;
-		}
+		m_profiler.SetTracer(&m_tracer);
+		m_tracer.SetThreadName("main");
+		m_tracer.Begin("header", m_sopts.input);
 	}
 
-	m_drvfnc->WriteFileEnd();
+	// the reports are written on every exit path, they matter the most when the conversion fails
+	const auto res = Convert(clcli, profiler);
+	WriteReports();
 
-	fclose(m_fp);
-	m_fp = nullptr;
+	if (res != 0)
+		return res;
 
 	if (m_sopts.verbose)
 		std::cout << "Writing success!" << std::endl;
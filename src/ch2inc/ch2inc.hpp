@@ -13,6 +13,8 @@
 #include <ch2parser.hpp>
 #include <cxxopts.hpp>
 
+struct ClangCli;
+
 /**
 * Main bootstrap of the application
 */
@@ -46,10 +48,24 @@ private:
 	void ShowHelp();
 
 	/**
-	* Sets up the driver
+	* Sets up the driver, a built-in driver or a driver library
+	* @return true if the driver was created, otherwise false
 	*/
 	bool SetupDriver();
 
+	/**
+	* Parses the input file and writes the output file
+	* @param clcli Arguments passed to clang
+	* @param profiler Profiler of the phases, can be NULL
+	* @return 0 on success, otherwise the exit code of the error
+	*/
+	int Convert(const ClangCli& clcli, Profiler* profiler);
+
+	/**
+	* Writes the time report, the statistics and the trace that were requested
+	*/
+	void WriteReports();
+
 	/**
 	* Adds default platform defines
 	*/
@@ -61,6 +77,12 @@ private:
 	/** serialized file */
 	CFile m_file;
 
+	/** phase timing */
+	Profiler m_profiler;
+
+	/** trace of the phases */
+	Tracer m_tracer;
+
 	/** options parser */
 	cxxopts::Options m_opt;
 
@@ -70,8 +92,8 @@ private:
 	/** output file */
 	FILE* m_fp;
 
-	/** driver entrypoint */
-	DriverEntrypointFunc m_drvep;
+	/** driver descriptor */
+	const DriverDescriptor* m_drvdesc;
 
 	/** driver functions */
 	Driver* m_drvfnc;
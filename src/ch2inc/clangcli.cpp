@@ -6,6 +6,8 @@
 */
 #include "clangcli.hpp"
 
+#include <cstring>
+
 /**
 * Simple utility to allocate the argv data and write data to it
 * @param p number of arguments that are inside argv
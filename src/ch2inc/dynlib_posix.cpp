@@ -0,0 +1,54 @@
+/**
+* @file dynlib_posix.cpp
+* @author lakor64
+* @date 18/10/2026
+* @brief dynamic library support for POSIX systems
+*/
+#include "dynlib.hpp"
+
+#if !defined(DISABLE_DYNLIB) && !defined(_WIN32)
+
+#include <dlfcn.h>
+
+#include <string>
+
+#ifdef __APPLE__
+#define DYNLIB_SUFFIX ".dylib"
+#else
+#define DYNLIB_SUFFIX ".so"
+#endif
+
+DynLib dynlib_load(const char* file)
+{
+	auto lib = dlopen(file, RTLD_NOW | RTLD_LOCAL);
+
+	if (lib)
+		return (DynLib)lib;
+
+	// like LoadLibrary, accept the name without the prefix and the extension (eg: ch2drvmasm)
+	std::string path = file;
+	const auto slash = path.rfind('/');
+	const auto name = slash == std::string::npos ? 0 : slash + 1;
+
+	// only the last component of the path can have the extension
+	if (path.find('.', name) != std::string::npos)
+		return nullptr;
+
+	path.insert(name, "lib");
+	path += DYNLIB_SUFFIX;
+
+	return (DynLib)dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+}
+
+void dynlib_free(DynLib lib)
+{
+	if (lib)
+		dlclose(lib);
+}
+
+void* dynlib_getfunc(DynLib lib, const char* funcname)
+{
+	return dlsym(lib, funcname);
+}
+
+#endif
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <platform.hpp>
+#include <parserconfig.hpp>
 
 #include <vector>
 #include <string>
@@ -19,7 +20,7 @@ struct Options
 	/**
 	* Default constructor
 	*/
-	explicit Options() : info(), nologo(false), msvc(false), verbose(false), macro_like_h2inc(false) {}
+	explicit Options() : info(), nologo(false), msvc(false), verbose(false), macros(MacroFilter::All), macro_refs(false), probe_macros(false), fast(false), jobs(1), functions(true), globals(true), enums(true), time_report(), trace(), stats() {}
 
 	/** Platform info */
 	PlatformInfo info;
@@ -41,10 +42,28 @@ struct Options
 	bool msvc;
 	/** Verbose logging */
 	bool verbose;
-	/** Write macros like h2inc */
-	bool macro_like_h2inc;
-#ifndef DISABLE_DYNLIB
-	/** Driver name */
+	/** Macros to write (only integers is like h2inc) */
+	MacroFilter macros;
+	/** Write macros as references to other macros */
+	bool macro_refs;
+	/** Evaluate the complex macros with clang */
+	bool probe_macros;
+	/** Fast parse of self-contained headers */
+	bool fast;
+	/** Threads used to write the output */
+	unsigned jobs;
+	/** Write the function declarations */
+	bool functions;
+	/** Write the global variables */
+	bool globals;
+	/** Write the enumerations */
+	bool enums;
+	/** Format of the time report (empty if disabled, "text" or "json") */
+	std::string time_report;
+	/** Chrome trace-event output file (empty if disabled) */
+	std::string trace;
+	/** Format of the statistics (empty if disabled, "text" or "json") */
+	std::string stats;
+	/** Driver name (built-in) or driver library */
 	std::string driver;
-#endif
 };
@@ -0,0 +1,157 @@
+/**
+* @file allocstats.cpp
+* @author lakor64
+* @date 18/10/2026
+* @brief allocation tracking per phase
+*/
+#include "allocstats.hpp"
+
+#include <array>
+#include <cstdlib>
+#include <new>
+
+/**
+* Atomic counters of a slot
+*/
+struct AllocSlot
+{
+	/** number of allocations */
+	std::atomic<uint64_t> allocs;
+	/** bytes allocated */
+	std::atomic<uint64_t> bytes;
+	/** number of deallocations */
+	std::atomic<uint64_t> frees;
+};
+
+/** counters of every slot, zero initialized as they can be used before main */
+static std::array<AllocSlot, AllocStats::MaxSlots> g_slots;
+
+/** slot of the current phase */
+static std::atomic<size_t> g_slot(AllocStats::NoPhase);
+
+void AllocStats::SetSlot(size_t slot)
+{
+	g_slot.store(slot < MaxSlots ? slot : NoPhase, std::memory_order_relaxed);
+}
+
+void AllocStats::AddAlloc(size_t bytes)
+{
+	auto& s = g_slots[g_slot.load(std::memory_order_relaxed)];
+	s.allocs.fetch_add(1, std::memory_order_relaxed);
+	s.bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void AllocStats::AddFree()
+{
+	g_slots[g_slot.load(std::memory_order_relaxed)].frees.fetch_add(1, std::memory_order_relaxed);
+}
+
+AllocStats::Counters AllocStats::Get(size_t slot)
+{
+	const auto& s = g_slots[slot < MaxSlots ? slot : NoPhase];
+
+	Counters c;
+	c.allocs = s.allocs.load(std::memory_order_relaxed);
+	c.bytes = s.bytes.load(std::memory_order_relaxed);
+	c.frees = s.frees.load(std::memory_order_relaxed);
+	return c;
+}
+
+#ifdef CH2_TRACK_ALLOCS
+/*
+* Counting replacements of the global allocation functions, they live in the same
+*  object as AllocStats so they are always linked together with the profiler.
+* The aligned overloads are left to the standard library as they do not go through these.
+*/
+
+/**
+* Allocates memory and records it
+* @param size Bytes to allocate
+* @return Allocated memory or NULL
+*/
+static void* tracked_alloc(size_t size) noexcept
+{
+	if (size == 0)
+		size = 1;
+
+	auto p = malloc(size);
+
+	if (p)
+		AllocStats::AddAlloc(size);
+
+	return p;
+}
+
+/**
+* Frees memory and records it
+* @param p Memory to free
+*/
+static void tracked_free(void* p) noexcept
+{
+	if (!p)
+		return;
+
+	AllocStats::AddFree();
+	free(p);
+}
+
+void* operator new(size_t size)
+{
+	auto p = tracked_alloc(size);
+
+	if (!p)
+		throw std::bad_alloc();
+
+	return p;
+}
+
+void* operator new[](size_t size)
+{
+	auto p = tracked_alloc(size);
+
+	if (!p)
+		throw std::bad_alloc();
+
+	return p;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return tracked_alloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return tracked_alloc(size);
+}
+
+void operator delete(void* p) noexcept
+{
+	tracked_free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+	tracked_free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+	tracked_free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+	tracked_free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+	tracked_free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+	tracked_free(p);
+}
+#endif
@@ -0,0 +1,76 @@
+/**
+* @file allocstats.hpp
+* @author lakor64
+* @date 18/10/2026
+* @brief allocation tracking per phase
+*/
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+* Counts the calls to the global operator new/delete and attributes them to the
+*  current profiler phase. The counting operators are only installed when the
+*  application is built with CH2_TRACK_ALLOCS.
+*/
+class AllocStats final
+{
+public:
+	/** number of slots, the last one collects the allocations done outside of any phase */
+	static constexpr size_t MaxSlots = 8;
+
+	/** slot used outside of the phases */
+	static constexpr size_t NoPhase = MaxSlots - 1;
+
+	/**
+	* Allocations of a slot
+	*/
+	struct Counters
+	{
+		/** number of allocations */
+		uint64_t allocs;
+		/** bytes allocated */
+		uint64_t bytes;
+		/** number of deallocations */
+		uint64_t frees;
+	};
+
+	/**
+	* Checks if the tracking was compiled in
+	* @return true if the application was built with CH2_TRACK_ALLOCS
+	*/
+	static constexpr bool IsEnabled()
+	{
+#ifdef CH2_TRACK_ALLOCS
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	/**
+	* Sets the slot that receives the next allocations
+	* @param slot Slot index or NoPhase
+	*/
+	static void SetSlot(size_t slot);
+
+	/**
+	* Records an allocation in the current slot
+	* @param bytes Size of the allocation
+	*/
+	static void AddAlloc(size_t bytes);
+
+	/**
+	* Records a deallocation in the current slot
+	*/
+	static void AddFree();
+
+	/**
+	* Gets the allocations of a slot
+	* @param slot Slot index or NoPhase
+	* @return Counters of the slot
+	*/
+	static Counters Get(size_t slot);
+};
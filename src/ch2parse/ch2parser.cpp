@@ -9,98 +9,150 @@
 #include "clangutils.hpp"
 #include "struct.hpp"
 #include "typedef.hpp"
+#include "stats.hpp"
 
 #include <algorithm>
 #include <deque>
+#include <unordered_set>
 #include <clang-c/Index.h>
 
-void CH2Parser::AddPrimitive(const std::string& name, PrimitiveType type, PrimitiveMods mod)
+void CH2Parser::Visit(const std::string& in, int clang_argc, const char** clang_argv, CFile& file, const PlatformInfo& plt)
 {
-	auto p = new Primitive();
-	p->m_name = name;
-	p->m_type = type;
-	p->m_mod = mod;
-	m_types.insert_or_assign(name, p);
+	m_cf = &file;
+
+	if (m_cfg.fast)
+	{
+		Parse(in, clang_argc, clang_argv, plt, true);
+
+		/*
+		* The fast profile does not enter the includes, anything declared there is unknown
+		*  and clang recovers from it in ways we cannot trust (includes, conditionals on unknown
+		*  macros and parse errors), so parse everything again.
+		*/
+		if (m_lasterr == CH2ErrorCodes::None && !HaveParseErrors())
+			return;
+
+		if (m_lasterr != CH2ErrorCodes::None && m_lasterr != CH2ErrorCodes::MissingType)
+			return;
+
+		Reset();
+	}
+
+	Parse(in, clang_argc, clang_argv, plt, false);
 }
 
-void CH2Parser::AddBasics(const PlatformInfo& plat)
+uint32_t CH2Parser::GetParseFlags(bool fast) const
 {
-	static std::vector<std::string> g_types = {
-		"char",
-		"short",
-		"int",
-		"long",
-		"long long",
-		"float",
-		"double",
-		"long double",
-		"wchar_t",
-		"__int128",
-		"*",
-	};
-
-	for (const auto& name : g_types)
-	{
-		const auto primitive_type = Utility::GetPrimitiveTypeForPlatform(name, plat);
-
-		if (PrimitiveType::Real4 == primitive_type ||
-			PrimitiveType::Real8 == primitive_type ||
-			PrimitiveType::Pointer == primitive_type)
-		{
-			AddPrimitive(name, primitive_type, PrimitiveMods::Default);
-			continue;
-		}
+	uint32_t flags = CXTranslationUnit_SkipFunctionBodies;
 
-		for (int i = static_cast<int>(PrimitiveMods::Default); i <= static_cast<int>(PrimitiveMods::Unsigned); i++)
-		{
-			std::string newName;
-			const auto mod = static_cast<PrimitiveMods>(i);
+	if (m_cfg.macros != MacroFilter::None)
+		flags |= CXTranslationUnit_DetailedPreprocessingRecord;
 
-			if (mod == PrimitiveMods::Unsigned)
-				newName = "unsigned " + name;
-			else if (mod == PrimitiveMods::Signed)
-				newName = "signed " + name;
-			else
-				newName = name;
+	if (fast)
+		flags |= CXTranslationUnit_SingleFileParse | CXTranslationUnit_KeepGoing | CXTranslationUnit_IgnoreNonErrorsFromIncludedFiles;
 
-			AddPrimitive(newName, primitive_type, mod);
-		}
+	return flags;
+}
+
+bool CH2Parser::HaveParseErrors() const
+{
+	if (!m_unit)
+		return false;
+
+	const auto ndiags = clang_getNumDiagnostics(m_unit);
+
+	for (unsigned i = 0; i < ndiags; i++)
+	{
+		auto diag = clang_getDiagnostic(m_unit, i);
+		const auto severity = clang_getDiagnosticSeverity(diag);
+		clang_disposeDiagnostic(diag);
+
+		if (severity >= CXDiagnostic_Error)
+			return true;
 	}
+
+	return false;
 }
 
-void CH2Parser::Visit(const std::string& in, int clang_argc, const char** clang_argv, CFile& file, const PlatformInfo& plt)
+void CH2Parser::Reset()
 {
+	std::unordered_set<BasicMember*> owned(m_cf->m_types.begin(), m_cf->m_types.end());
+	std::unordered_set<BasicMember*> internal;
 
-	m_cf = &file;
+	// function prototypes are only referenced by the parser
+	for (const auto& it : m_types)
+	{
+		if (owned.find(it.second) == owned.end())
+			internal.insert(it.second);
+	}
+
+	for (auto m : internal)
+		delete m;
+
+	for (auto m : m_cf->m_types)
+		delete m;
 
-	// add basic primitives
-	AddBasics(plt);
+	m_cf->m_types.clear();
+	m_types.clear();
+	m_defs.clear();
+	m_macros.clear();
+	m_macro_index.clear();
+	m_redefined.clear();
+	m_outer_macros.clear();
+	m_tokens.Reset(nullptr);
 
-	// create index
+	if (m_unit)
+	{
+		clang_disposeTranslationUnit(m_unit);
+		m_unit = nullptr;
+	}
+
+	if (m_index)
+	{
+		clang_disposeIndex(m_index);
+		m_index = nullptr;
+	}
+
+	m_lasterr = CH2ErrorCodes::None;
+}
+
+void CH2Parser::Parse(const std::string& in, int clang_argc, const char** clang_argv, const PlatformInfo& plt, bool fast)
+{
+	m_fast = fast;
+
+	// basic primitives, the sizes of the types depend on the platform (eg: sizeof(int) in 16-bit is 2 bytes)
+	m_prims = &PrimitiveTable::Get(plt);
+
+	// create index, the errors of the fast parse are not shown as the full parse might be done
+	{
+		ProfileScope scope(m_profiler, ProfilePhase::Index);
 
 #if CINDEX_VERSION_MINOR > 63 || CINDEX_VERSION_MAJOR > 0
-	CXIndexOptions opts = {};
-	opts.Size = sizeof(opts);
-	opts.DisplayDiagnostics = 1;
+		CXIndexOptions opts = {};
+		opts.Size = sizeof(opts);
+		opts.DisplayDiagnostics = fast ? 0 : 1;
 
-	auto index = clang_createIndexWithOptions(&opts);
+		m_index = clang_createIndexWithOptions(&opts);
 #else
-	auto index = clang_createIndex(0, 1);
+		m_index = clang_createIndex(0, fast ? 0 : 1);
 #endif
+	}
 
-	if (!index)
+	if (!m_index)
 	{
 		m_lasterr = CH2ErrorCodes::IndexError;
 		return;
 	}
 
 	// create translation unit
-	uint32_t flags = CXTranslationUnit_DetailedPreprocessingRecord | CXTranslationUnit_SkipFunctionBodies;
-
-	const auto ec = clang_parseTranslationUnit2(index, in.c_str(), clang_argv, clang_argc,
-		nullptr, 0, 
-		flags,
-		&m_unit);
+	CXErrorCode ec;
+	{
+		ProfileScope scope(m_profiler, ProfilePhase::Parse);
+		ec = clang_parseTranslationUnit2(m_index, in.c_str(), clang_argv, clang_argc,
+			nullptr, 0, 
+			GetParseFlags(fast),
+			&m_unit);
+	}
 
 	if (ec != CXError_Success)
 	{
@@ -108,6 +160,12 @@ void CH2Parser::Visit(const std::string& in, int clang_argc, const char** clang_
 		return;
 	}
 
+	if (m_profiler)
+		m_profiler->ReadResourceUsage(m_unit);
+
+	m_tokens.Reset(m_unit);
+	m_tokens.SetTracer(m_profiler ? m_profiler->GetTracer() : nullptr);
+
 	for (int i = 0; i < clang_argc; i++)
 	{
 		if (clang_argv[i][0] == '-' && clang_argv[i][1] == 'D' && clang_argv[i][2] != '\0')
@@ -122,11 +180,38 @@ void CH2Parser::Visit(const std::string& in, int clang_argc, const char** clang_
 	}
 
 	// start visiting
-	auto cursor = clang_getTranslationUnitCursor(m_unit);
-	clang_visitChildren(cursor, [](CXCursor c, CXCursor parent, CXClientData data)
-		-> CXChildVisitResult {
-			return ((CH2Parser*)data)->ParseChild(c, parent);
-		}, this);
+	{
+		ProfileScope scope(m_profiler, ProfilePhase::Visit);
+
+		auto cursor = clang_getTranslationUnitCursor(m_unit);
+		clang_visitChildren(cursor, [](CXCursor c, CXCursor parent, CXClientData data)
+			-> CXChildVisitResult {
+				return ((CH2Parser*)data)->ParseChild(c, parent);
+			}, this);
+
+		if (fast && m_lasterr == CH2ErrorCodes::None && !CheckFastConditionals(in))
+		{
+			m_lasterr = CH2ErrorCodes::MissingType;
+			return;
+		}
+	}
+
+	// evaluate the preprocessor definitions now that all of them are known
+	{
+		ProfileScope scope(m_profiler, ProfilePhase::Macro);
+
+		ResolveMacros();
+
+		if (m_cfg.probe_macros && m_lasterr == CH2ErrorCodes::None)
+			ProbeMacros(in, clang_argc, clang_argv);
+
+		DropMacros();
+	}
+
+	ProfileScope scope(m_profiler, ProfilePhase::Fixup);
+
+	if (m_cfg.layout)
+		FinishLayouts();
 
 	/*
 	* During nested structures, clang parses a nested after the parent structure
@@ -136,12 +221,105 @@ void CH2Parser::Visit(const std::string& in, int clang_argc, const char** clang_
 	FixupDecls();
 }
 
+/**
+* Checks if there is a line break between two tokens
+* @param a First token
+* @param b Next token
+* @return true if the tokens are on different lines
+*/
+static bool is_new_line(const CachedToken& a, const CachedToken& b)
+{
+	const auto start = a.spelling.data() + a.spelling.size();
+	const std::string_view gap(start, b.spelling.data() - start);
+
+	for (size_t i = 0; i < gap.size(); i++)
+	{
+		if (gap[i] != '\n')
+			continue;
+
+		// line continuation
+		if (i > 0 && (gap[i - 1] == '\\' || (gap[i - 1] == '\r' && i > 1 && gap[i - 2] == '\\')))
+			continue;
+
+		return true;
+	}
+
+	return false;
+}
+
+bool CH2Parser::CheckFastConditionals(const std::string& in)
+{
+	const auto tokens = m_tokens.GetFile(clang_getFile(m_unit, in.c_str()));
+	std::unordered_set<std::string_view> known(m_outer_macros.begin(), m_outer_macros.end());
+	// for each open conditional, true if it's an #ifndef of an unknown macro
+	std::vector<bool> open;
+
+	for (size_t i = 0; i + 1 < tokens.size(); i++)
+	{
+		if (tokens[i].spelling != "#" || (i > 0 && !is_new_line(tokens[i - 1], tokens[i])))
+			continue;
+
+		const auto directive = tokens[i + 1].spelling;
+
+		// the fast parse does not enter the includes, the types declared there are missing
+		if (directive == "include" || directive == "include_next" || directive == "import")
+			return false;
+
+		size_t end = i + 2;
+
+		while (end < tokens.size() && !is_new_line(tokens[end - 1], tokens[end]))
+			end++;
+
+		bool unknown = false;
+		for (size_t k = i + 2; k < end; k++)
+		{
+			if (tokens[k].kind == CXToken_Identifier && tokens[k].spelling != "defined" && known.find(tokens[k].spelling) == known.end())
+				unknown = true;
+		}
+
+		if (directive == "define" && end > i + 2)
+			known.insert(tokens[i + 2].spelling);
+		else if (directive == "undef" && end > i + 2)
+			known.erase(tokens[i + 2].spelling);
+		else if (directive == "ifndef")
+			open.push_back(unknown); // only the first branch is right (eg: include guards)
+		else if (directive == "if" || directive == "ifdef")
+		{
+			if (unknown)
+				return false;
+
+			open.push_back(false);
+		}
+		else if (directive == "elif" || directive == "elifdef" || directive == "elifndef" || directive == "else")
+		{
+			if (unknown || (!open.empty() && open.back()))
+				return false;
+		}
+		else if (directive == "endif" && !open.empty())
+			open.pop_back();
+
+		i = end - 1;
+	}
+
+	return true;
+}
+
 BasicMember* CH2Parser::FindType(const std::string& name)
 {
 	const auto& it = m_types.find(name);
 	if (it == m_types.end())
-		return nullptr;
+	{
+		auto prim = m_prims ? m_prims->Find(name) : nullptr;
 
+		if (prim)
+			CH2_STAT(FindTypeHits);
+		else
+			CH2_STAT(FindTypeMisses);
+
+		return prim;
+	}
+
+	CH2_STAT(FindTypeHits);
 	return it->second;
 }
 
@@ -240,7 +418,7 @@ bool CH2Parser::SetupVariable(Variable& v, CXType type, CXCursor c)
 
 	if (baseType.kind == CXType_Void && v.m_ref.pointers > 0)
 	{
-		v.m_ref.ref_type = FindType("*"); // primitive pointer type
+		v.m_ref.ref_type = m_prims->Find(PrimitiveKind::Pointer); // primitive pointer type
 		return v.m_ref.ref_type != nullptr;
 	}
 
@@ -252,15 +430,20 @@ bool CH2Parser::SetupVariable(Variable& v, CXType type, CXCursor c)
 		v.m_ref.ref_type->m_name = new_name;
 		m_types.insert_or_assign(new_name, v.m_ref.ref_type);
 	}
-	else if (baseType.kind == CXType_Enum)
+	else if (baseType.kind == CXType_Enum || (baseType.kind == CXType_Elaborated && clang_Type_getNamedType(baseType).kind == CXType_Enum))
 	{
-		const auto& baseName = Utility::GetPrimitiveNameFromSize(clang_Type_getSizeOf(baseType) * 8);
-		v.m_ref.ref_type = FindType(baseName);
+		// the pointed enumerations are elaborated (eg: "enum a*"), they are written as their integer type as well
+		v.m_ref.ref_type = m_prims->Find(PrimitiveTable::GetKindFromSize(clang_Type_getSizeOf(baseType) * 8));
 	}
 	else
 	{
-		const auto& baseName = GetNormalizedName(baseType);
-		v.m_ref.ref_type = FindType(baseName);
+		v.m_ref.ref_type = m_prims->Find(baseType.kind);
+
+		if (!v.m_ref.ref_type)
+		{
+			const auto& baseName = GetNormalizedName(baseType);
+			v.m_ref.ref_type = FindType(baseName);
+		}
 	}
 
 	if (v.m_ref.ref_type == nullptr)
@@ -282,6 +465,8 @@ CXChildVisitResult CH2Parser::ParseChild(CXCursor cursor, CXCursor parent)
 	BasicMember* member = nullptr;
 	bool skip = false, skipadd = false;
 
+	CH2_STAT_CURSOR(kind);
+
 	switch (kind)
 	{
 	case CXCursor_StructDecl:
@@ -299,6 +484,13 @@ CXChildVisitResult CH2Parser::ParseChild(CXCursor cursor, CXCursor parent)
 		break;
 
 	case CXCursor_EnumDecl:
+		if (!m_cfg.enums)
+		{
+			AliasEnum(cursor);
+			skip = true; // the constants are not visited
+			break;
+		}
+
 		member = VisitEnum(cursor);
 		break;
 
@@ -310,6 +502,16 @@ CXChildVisitResult CH2Parser::ParseChild(CXCursor cursor, CXCursor parent)
 	case CXCursor_MacroDefinition:
 	{
 		skip = true;
+
+		if (m_fast && clang_Location_isFromMainFile(clang_getCursorLocation(cursor)) == 0)
+		{
+			ClangStr name(clang_getCursorSpelling(cursor));
+			m_outer_macros.emplace(name.Get());
+		}
+
+		if (m_cfg.macros == MacroFilter::None)
+			break;
+
 		// skip builtin macros and function-like macros
 		if (clang_Cursor_isMacroBuiltin(cursor) == 0 && clang_Cursor_isMacroFunctionLike(cursor) == 0)
 		{
@@ -341,13 +543,29 @@ CXChildVisitResult CH2Parser::ParseChild(CXCursor cursor, CXCursor parent)
 		break;
 	}
 	case CXCursor_FunctionDecl:
+		if (!m_cfg.functions)
+		{
+			skip = true;
+			break;
+		}
+
 		member = VisitFunc(cursor);
 		break;
 
 	case CXCursor_VarDecl:
+		if (!m_cfg.globals)
+		{
+			skip = true;
+			break;
+		}
+
 		member = VisitVarDecl(cursor);
 		break;
 
+	case CXCursor_InclusionDirective:
+		skip = true; // skip inclusions as they are part of preprocessor
+		break;
+
 	case CXCursor_FirstExpr:
 	case CXCursor_BinaryOperator:
 	case CXCursor_IntegerLiteral: // skip, we don't read literals
@@ -359,11 +577,11 @@ CXChildVisitResult CH2Parser::ParseChild(CXCursor cursor, CXCursor parent)
 	case CXCursor_ObjCStringLiteral:
 	case CXCursor_CompoundLiteralExpr:
 	case CXCursor_CXXNullPtrLiteralExpr:
-	case CXCursor_InclusionDirective: // skip inclusions as they are part of preprocessor
 	case CXCursor_ParmDecl: // we have parsed them already
 	case CXCursor_MacroExpansion: // skip macro expansions, we do not support %ifdef %else %endif and neither h2inc did
 	case CXCursor_TypeRef:
 	case CXCursor_ParenExpr:
+	case CXCursor_StaticAssert: // nothing to write
 		skip = true;
 		break;
 
@@ -380,17 +598,24 @@ CXChildVisitResult CH2Parser::ParseChild(CXCursor cursor, CXCursor parent)
 	}
 
 	if (skip)
+	{
+		CH2_STAT(CursorsSkipped);
 		return CXChildVisit_Continue;
+	}
+
+	if (member)
+		CH2_STAT(MembersCreated);
 
 	if (!skipadd)
 	{
 		if (!member)
 			return CXChildVisit_Break;
 
-		const auto& it = m_types.find(member->GetName());
-
-		if (it != m_types.end())
+		// not a type lookup, this must not count in the FindType statistics
+		const auto& name = member->GetName();
+		if (m_types.find(name) != m_types.end() || m_prims->Find(name))
 		{
+			CH2_STAT(MembersDuplicated);
 			delete member;
 			/*
 			* libclang parses nested structures two times, probably this is done because
@@ -504,21 +729,25 @@ void CH2Parser::FixupDecls()
 		order_map.insert_or_assign(types[i]->GetName(), i);
 	}
 
+	// the pushed members always go after every ordered member, the map can have
+	//  less entries than the highest order as the pushed members are erased from it
+	size_t next_order = types.size();
+
 	while (true)
 	{
 		// destroy all the missing symbols until we have resolved everything
 
 		push_members = do_sorting(order_map, types);
+		CH2_STAT(FixupPasses);
 
 		if (push_members.empty())
 			break;
 
-		size_t i = order_map.size();
 		for (const auto& m : push_members)
 		{
-			order_map.insert_or_assign(m->GetName(), i);
+			order_map.insert_or_assign(m->GetName(), next_order);
 			m_cf->m_types.emplace_back(m);
-			i++;
+			next_order++;
 		}
 
 	}
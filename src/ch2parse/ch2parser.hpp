@@ -12,9 +12,16 @@
 #include "define.hpp"
 #include "function.hpp"
 #include "variable.hpp"
+#include "struct.hpp"
+#include "tokencache.hpp"
+#include "parserconfig.hpp"
+#include "primitivetable.hpp"
+#include "profiler.hpp"
 
 #include <clang-c/Index.h>
 
+#include <unordered_set>
+
 /**
 * This class uses libclang AST to perform the visiting of a C header file and
 * serializes data back to the specific CFile
@@ -25,7 +32,7 @@ public:
 	/**
 	* Default constructor
 	*/
-	explicit CH2Parser() : m_lasterr(CH2ErrorCodes::None), m_cf(nullptr), m_unit(nullptr) {}
+	explicit CH2Parser() : m_lasterr(CH2ErrorCodes::None), m_cf(nullptr), m_index(nullptr), m_unit(nullptr), m_cfg(), m_fast(false), m_prims(nullptr), m_profiler(nullptr) {}
 
 	/**
 	* Default deconstructor
@@ -54,8 +61,58 @@ public:
 	*/
 	constexpr bool HaveError() const { return m_lasterr != CH2ErrorCodes::None; }
 
+	/**
+	* Sets the parser config
+	* @param cfg Parser config
+	*/
+	void SetConfig(const ParserConfig& cfg) { m_cfg = cfg; }
+
+	/**
+	* Sets the profiler that times the parse phases
+	* @param profiler Profiler to use or NULL to disable the timing
+	*/
+	void SetProfiler(Profiler* profiler) { m_profiler = profiler; }
+
 private:
 
+	/**
+	* Parses the input file and visits it
+	* @param in Input file
+	* @param clang_argc number of c arguments to pass to clang
+	* @param clang_argv argument pointer to pass to clang
+	* @param plat Platform configuration
+	* @param fast true to use the fast parse profile
+	*/
+	void Parse(const std::string& in, int clang_argc, const char** clang_argv, const PlatformInfo& plat, bool fast);
+
+	/**
+	* Gets the translation unit flags of a parse profile
+	* @param fast true to get the fast parse profile
+	* @return libclang translation unit flags
+	*/
+	uint32_t GetParseFlags(bool fast) const;
+
+	/**
+	* Checks if clang reported any error in the translation unit
+	* @return true if there are errors, otherwise false
+	*/
+	bool HaveParseErrors() const;
+
+	/**
+	* Destroys everything parsed so the file can be parsed again
+	*/
+	void Reset();
+
+	/**
+	* Checks if the single file preprocessing of the fast parse matches the full one.
+	* Clang enters every branch of a conditional that tests an unknown macro when
+	*  it is not following the includes, this gives wrong or duplicated definitions.
+	* Any inclusion directive fails the check as the included declarations are missing.
+	* @param in Input file
+	* @return true if the fast parse can be used, otherwise false
+	*/
+	bool CheckFastConditionals(const std::string& in);
+
 	/**
 	* Parses a single child in the AST
 	* @param cursor Current cursor
@@ -90,6 +147,13 @@ private:
 	*/
 	BasicMember* VisitEnum(CXCursor c);
 
+	/**
+	* Makes an enumeration type name refer to its integer type, this is used
+	*  when the enumerations are not parsed
+	* @param c Cursor to the enumeration
+	*/
+	void AliasEnum(CXCursor c);
+
 	/**
 	* Visits an enum declaration
 	* @param c Cursor to the data
@@ -167,31 +231,103 @@ private:
 	BasicMember* FindType(CXCursor type);
 
 	/**
-	* Adds a primitive type to the parser
-	* @param name Primitive name
-	* @param type Primitive type
-	* @param mod Primitive modificator
+	* Fix order of declarations
 	*/
-	void AddPrimitive(const std::string& name, PrimitiveType type, PrimitiveMods mod);
+	void FixupDecls();
 
 	/**
-	* Adds basic platform types to the parser reference, this is done so we can use
-	* correct sizes of types per platform
-	* example: sizeof(int) in 16-bit is 2 bytes
-	* @param plat Platform configuration
+	* Adds the last field of a structure to its layout
+	* @param s Structure to update
+	* @param f Field to add
+	* @param storage Size of the type of the field in bits
 	*/
-	void AddBasics(const PlatformInfo& plat);
+	void AddFieldLayout(Struct* s, const StructField* f, int64_t storage);
 
 	/**
-	* Fix order of declarations
+	* Adds the padding to the layout of all the visited structures
 	*/
-	void FixupDecls();
+	void FinishLayouts();
+
+	/**
+	* Resolves all the visited preprocessor definitions, every definition is
+	*  evaluated only once and the result is reused by the definitions that reference it
+	*/
+	void ResolveMacros();
+
+	/**
+	* Removes the unsupported preprocessor definitions from the file
+	*/
+	void DropMacros();
+
+	/**
+	* Resolves a single preprocessor definition and its dependencies
+	* @param idx Index of the definition
+	* @return true if the definition is valid, false if it has been dropped or it's part of a cycle
+	*/
+	bool ResolveMacro(size_t idx);
+
+	/**
+	* Classifies the value of a preprocessor definition
+	* @param idx Index of the definition
+	* @return true if the definition is supported, otherwise false
+	*/
+	bool ClassifyMacro(size_t idx);
+
+	/**
+	* Finds a visited preprocessor definition
+	* @param name Name of the definition
+	* @return Index of the definition or SIZE_MAX if it's not found
+	*/
+	size_t FindMacro(std::string_view name) const;
+
+	/**
+	* Evaluates the definitions that cannot be computed from their tokens by compiling
+	*  them with clang, every definition is evaluated by a single extra parse
+	* @param in Input file
+	* @param clang_argc number of c arguments to pass to clang
+	* @param clang_argv argument pointer to pass to clang
+	*/
+	void ProbeMacros(const std::string& in, int clang_argc, const char** clang_argv);
+
+	/**
+	* Parses the probe translation unit and reads back the value of the definitions
+	* @param in Input file
+	* @param clang_argc number of c arguments to pass to clang
+	* @param clang_argv argument pointer to pass to clang
+	* @param probes Index of the definitions to evaluate
+	*/
+	void ParseProbes(const std::string& in, int clang_argc, const char** clang_argv, const std::vector<size_t>& probes);
+
+	/**
+	* Sets the integer value of a define
+	* @param def Define to modify
+	* @param value Integer value (two's complement if signed)
+	* @param is_unsigned true if the value is unsigned
+	*/
+	static void SetDefineNumber(Define* def, uint64_t value, bool is_unsigned);
+
+	/**
+	* Expands the defines referenced by the tokens of a define
+	* @param tokens Tokens of the define (including the name)
+	* @param active Defines that are being expanded
+	* @param out Expanded tokens
+	*/
+	void ExpandTokens(const TokenSlice& tokens, std::vector<size_t>& active, std::vector<CachedToken>& out) const;
 
 	/**
 	* Evalutates a define and computes it's value
 	* @param def Define to valutate
+	* @param tokens Tokens of the define (including the name)
 	*/
-	void EvalDefine(Define* def);
+	void EvalDefine(Define* def, const TokenSlice& tokens);
+
+	/**
+	* Joins the spelling of the tokens back to a string
+	* @param tokens Tokens to join
+	* @param first Index of the first token to join
+	* @return Joined string
+	*/
+	static std::string JoinTokens(const TokenSlice& tokens, size_t first);
 
 	/**
 	* Visits a function
@@ -223,8 +359,88 @@ private:
 	*/
 	std::vector<std::string> m_defs;
 
+	/**
+	* clang index
+	*/
+	CXIndex m_index;
+
 	/**
 	* clang translation unit
 	*/
 	CXTranslationUnit m_unit;
+
+	/**
+	* tokens of the parsed files, shared by all the macro definitions
+	*/
+	TokenCache m_tokens;
+
+	/**
+	* Resolution state of a preprocessor definition
+	*/
+	enum class MacroState
+	{
+		/** not resolved yet */
+		Pending,
+		/** resolution in progress (used to detect cycles) */
+		Resolving,
+		/** resolved */
+		Resolved,
+		/** not supported, removed from the output */
+		Dropped,
+	};
+
+	/**
+	* A node of the preprocessor definitions dependency graph
+	*/
+	struct MacroNode
+	{
+		/** definition */
+		Define* def;
+		/** tokens of the definition (including the name) */
+		TokenSlice tokens;
+		/** resolution state */
+		MacroState state;
+		/** the definition uses keywords (sizeof, casts...) and it can only be evaluated by the probe */
+		bool probe;
+	};
+
+	/**
+	* visited preprocessor definitions in declaration order
+	*/
+	std::vector<MacroNode> m_macros;
+
+	/**
+	* index of the preprocessor definitions by name
+	*/
+	std::unordered_map<std::string_view, size_t> m_macro_index;
+
+	/**
+	* preprocessor definitions that are defined more than once
+	*/
+	std::unordered_set<std::string> m_redefined;
+
+	/**
+	* parser configuration
+	*/
+	ParserConfig m_cfg;
+
+	/**
+	* the current parse uses the fast profile
+	*/
+	bool m_fast;
+
+	/**
+	* macros defined outside of the input file (builtins and command line), only used by the fast parse
+	*/
+	std::unordered_set<std::string> m_outer_macros;
+
+	/**
+	* primitives of the current platform
+	*/
+	const PrimitiveTable* m_prims;
+
+	/**
+	* phase timing, can be NULL
+	*/
+	Profiler* m_profiler;
 };
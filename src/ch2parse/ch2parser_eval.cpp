@@ -5,28 +5,687 @@
 * @brief evalutation code
 */
 #include "ch2parser.hpp"
-#include <exprtk.hpp>
+#include "macroeval.hpp"
+#include "clangutils.hpp"
+#include "stats.hpp"
 
-void CH2Parser::EvalDefine(Define* def)
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <sstream>
+#include <unordered_set>
+
+std::string CH2Parser::JoinTokens(const TokenSlice& tokens, size_t first)
+{
+	std::string str;
+
+	for (size_t i = first; i < tokens.size(); i++)
+	{
+		// keep words separated
+		if (i > first && tokens[i].kind != CXToken_Punctuation && tokens[i - 1].kind != CXToken_Punctuation)
+			str += ' ';
+
+		str += tokens[i].spelling;
+	}
+
+	return str;
+}
+
+size_t CH2Parser::FindMacro(std::string_view name) const
+{
+	const auto it = m_macro_index.find(name);
+	if (it == m_macro_index.end())
+		return SIZE_MAX;
+
+	return it->second;
+}
+
+void CH2Parser::ResolveMacros()
+{
+	bool has_refs = false;
+
+	for (const auto& node : m_macros)
+	{
+		for (const auto& tok : node.tokens)
+		{
+			if (&tok != node.tokens.begin() && tok.kind == CXToken_Identifier)
+			{
+				has_refs = true;
+				break;
+			}
+		}
+
+		if (has_refs)
+			break;
+	}
+
+	// the index is only needed when a definition references another one
+	if (has_refs)
+	{
+		m_macro_index.reserve(m_macros.size());
+
+		for (size_t i = 0; i < m_macros.size(); i++)
+			m_macro_index.emplace(m_macros[i].def->GetName(), i);
+	}
+
+	for (size_t i = 0; i < m_macros.size(); i++)
+	{
+		ResolveMacro(i);
+
+		if (m_lasterr != CH2ErrorCodes::None)
+			return;
+	}
+}
+
+void CH2Parser::DropMacros()
+{
+	std::unordered_set<const BasicMember*> dropped;
+
+	for (auto& node : m_macros)
+	{
+		if (m_cfg.macros == MacroFilter::Int && node.state == MacroState::Resolved)
+		{
+			const auto type = node.def->GetDefineType();
+
+			if (type != DefineType::Integer && type != DefineType::Hexadecimal && type != DefineType::Octal)
+				node.state = MacroState::Dropped;
+		}
+
+		if (node.state == MacroState::Dropped)
+			dropped.insert(node.def);
+	}
+
+	if (dropped.empty())
+		return;
+
+	// the kept definitions cannot point to the deleted ones
+	for (auto& node : m_macros)
+	{
+		if (node.state == MacroState::Dropped)
+			continue;
+
+		auto def = node.def;
+		auto& deps = def->m_deps;
+
+		deps.erase(std::remove_if(deps.begin(), deps.end(), [&dropped](const Define* d) {
+			return dropped.find(d) != dropped.end();
+		}), deps.end());
+
+		for (auto& tok : def->m_expr)
+		{
+			if (tok.type != DefineTokenType::Reference || dropped.find(tok.ref) == dropped.end())
+				continue;
+
+			// a single number is written as its value, anything else cannot be written as an expression
+			if (!tok.ref->HasNumber() || !tok.ref->GetExpression().empty())
+			{
+				def->m_expr.clear();
+				break;
+			}
+
+			tok.type = DefineTokenType::Number;
+			tok.number = tok.ref->GetNumber();
+			tok.text = std::to_string(tok.number);
+			tok.ref = nullptr;
+		}
+	}
+
+	// remove the unsupported definitions
+	auto& types = m_cf->m_types;
+
+	types.erase(std::remove_if(types.begin(), types.end(), [&dropped](BasicMember* m) {
+		return dropped.find(m) != dropped.end();
+	}), types.end());
+
+	for (auto& node : m_macros)
+	{
+		if (node.state != MacroState::Dropped)
+			continue;
+
+		m_macro_index.erase(node.def->GetName());
+		m_types.erase(node.def->GetName());
+		delete node.def;
+		node.def = nullptr;
+	}
+}
+
+bool CH2Parser::ResolveMacro(size_t idx)
+{
+	auto& node = m_macros[idx];
+
+	switch (node.state)
+	{
+	case MacroState::Resolved:
+		return true;
+	case MacroState::Resolving: // cycle
+	case MacroState::Dropped:
+		return false;
+	default:
+		break;
+	}
+
+	node.state = MacroState::Resolving;
+
+	// NOTE: node might be invalidated by the recursion, always access by index
+	const bool ok = ClassifyMacro(idx);
+	m_macros[idx].state = ok ? MacroState::Resolved : MacroState::Dropped;
+	return ok;
+}
+
+/**
+* Checks if a define type is a number
+* @param type Type of the define
+* @return true if the define is a number of any radix, otherwise false
+*/
+static bool is_number_type(DefineType type)
+{
+	switch (type)
+	{
+	case DefineType::Integer:
+	case DefineType::Hexadecimal:
+	case DefineType::Octal:
+	case DefineType::Binary:
+	case DefineType::Float:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/**
+* Checks if the value of a define was built only from decimal numbers, the value of
+*  a float define is written as it is and the other radixes would lose their prefix
+* @param def Define to check
+* @param tokens Tokens of the define (including the name)
+* @return true if every number of the value is decimal, otherwise false
+*/
+static bool is_decimal_value(const Define* def, const TokenSlice& tokens)
+{
+	for (const auto dd : def->GetDependencies())
+	{
+		if (dd->GetDefineType() != DefineType::Integer && dd->GetDefineType() != DefineType::Float)
+			return false;
+	}
+
+	for (size_t i = 1; i < tokens.size(); i++)
+	{
+		const auto str = tokens[i].spelling;
+
+		if (tokens[i].kind == CXToken_Literal && str.size() > 1 && str[0] == '0' && str[1] != '.')
+			return false;
+	}
+
+	return true;
+}
+
+bool CH2Parser::ClassifyMacro(size_t idx)
+{
+	const auto tokens = m_macros[idx].tokens;
+	const auto rt = m_macros[idx].def;
+
+	for (auto i = 1U; i < tokens.size(); i++) // skip name
+	{
+		const auto kind = tokens[i].kind;
+		auto value_str = tokens[i].spelling;
+
+		switch (kind)
+		{
+		case CXToken_Punctuation:
+			if (rt->m_defType == DefineType::Text && value_str == "(" && !m_macros[idx].probe) // not supported, sorry
+				return false;
+
+			rt->m_value += value_str;
+			break;
+		case CXToken_Identifier:
+		{
+			const auto ref = FindMacro(value_str);
+
+			if (ref == SIZE_MAX || !ResolveMacro(ref))
+			{
+				rt->m_value += value_str;
+				rt->m_defType = DefineType::Text;
+				continue;
+			}
+
+			// the value of the referenced define is already resolved
+			const auto dd = m_macros[ref].def;
+			rt->m_value += dd->GetValue();
+			rt->m_deps.push_back(dd);
+
+			if (rt->m_defType == DefineType::None)
+				rt->m_defType = dd->GetDefineType();
+
+			// numbers of different radixes can still be an expression, EvalDefine decides it
+			if (dd->GetDefineType() != rt->m_defType && (!is_number_type(dd->GetDefineType()) || !is_number_type(rt->m_defType)))
+				rt->m_defType = DefineType::Text;
+
+			break;
+		}
+		case CXToken_Literal:
+		{
+			// does the token starts with a string literal?
+			if (value_str[0] == '"')
+			{
+				rt->m_defType = DefineType::String;
+
+				const auto e = value_str.find_last_of('"');
+				if (e == std::string_view::npos)
+				{
+					// invalid string
+					m_lasterr = CH2ErrorCodes::ValueError;
+					return false;
+				}
+
+				value_str = value_str.substr(1, e - 1);
+				rt->m_value += value_str;
+			}
+			else if (isdigit(value_str[0]))
+			{
+				// we might have an int literal
+
+				if (value_str.size() > 1 && value_str[0] == '0' && (value_str[1] == 'x' || value_str[1] == 'X'))
+				{
+					rt->m_defType = DefineType::Hexadecimal;
+					value_str = value_str.substr(2);
+				}
+				else if (value_str.size() > 1 && value_str[0] == '0' && (value_str[1] == 'b' || value_str[1] == 'B'))
+				{
+					rt->m_defType = DefineType::Binary;
+					value_str = value_str.substr(2);
+				}
+				else if (value_str.size() > 1 && value_str[0] == '0' && isdigit(value_str[1]))
+				{
+					rt->m_defType = DefineType::Octal;
+					value_str = value_str.substr(1);
+				}
+				else
+					rt->m_defType = DefineType::Integer;
+
+				if (rt->m_defType != DefineType::Hexadecimal &&
+					(value_str.find_first_of(".eE") != std::string_view::npos || value_str.back() == 'f' || value_str.back() == 'F'))
+					rt->m_defType = DefineType::Float;
+
+				size_t m = 0;
+				for (; m < value_str.size(); m++)
+				{
+					if (!isxdigit(value_str[m]) && value_str[m] != '.')
+						break;
+
+					if (rt->m_defType != DefineType::Hexadecimal && !isdigit(value_str[m]) && value_str[m] != '.')
+						break;
+				}
+
+				// remove ULL and similar marks
+				value_str = value_str.substr(0, m);
+
+				rt->m_value += value_str;
+			}
+			else if (value_str[0] == '\'')
+			{
+				// character constants are integers
+				MacroValue v;
+				if (!MacroEval::ParseLiteral(value_str, v))
+					return false;
+
+				rt->m_defType = DefineType::Integer;
+				rt->m_value += std::to_string(static_cast<int64_t>(v.value));
+			}
+			else if (rt->m_defType == DefineType::None)
+				return false;
+
+			break;
+		}
+		case CXToken_Keyword:
+			// sizeof, casts and similar can only be computed by clang
+			if (!m_cfg.probe_macros)
+				return false;
+
+			m_macros[idx].probe = true;
+			break;
+		default:
+			return false;
+		}
+	}
+
+	if (m_macros[idx].probe)
+	{
+		rt->m_defType = DefineType::Text;
+		rt->m_value = JoinTokens(tokens, 1);
+		return true;
+	}
+
+	if (!is_number_type(rt->m_defType))
+		return true;
+
+	// anything more complex than a single value is an expression
+	if (tokens.size() > 2)
+	{
+		CH2_STAT(MacrosEvaluated);
+		EvalDefine(rt, tokens);
+		return true;
+	}
+
+	MacroValue v;
+
+	if (tokens[1].kind == CXToken_Literal && MacroEval::ParseLiteral(tokens[1].spelling, v))
+	{
+		rt->m_number = v.value;
+		rt->m_unsigned = v.is_unsigned;
+		rt->m_hasNumber = true;
+	}
+	else if (tokens[1].kind == CXToken_Identifier && rt->m_deps.size() == 1 && rt->m_deps[0]->HasNumber())
+	{
+		// alias of another define
+		const auto dd = rt->m_deps[0];
+		rt->m_number = dd->GetNumber();
+		rt->m_unsigned = dd->IsUnsigned();
+		rt->m_hasNumber = true;
+
+		DefineToken tok(DefineTokenType::Reference);
+		tok.text = dd->GetName();
+		tok.ref = dd;
+		rt->m_expr.push_back(std::move(tok));
+	}
+
+	return true;
+}
+
+void CH2Parser::ExpandTokens(const TokenSlice& tokens, std::vector<size_t>& active, std::vector<CachedToken>& out) const
 {
-	exprtk::expression<double> expression;
-	exprtk::parser<double> parser;
+	// the first token is the name of the define
+	for (size_t i = 1; i < tokens.size(); i++)
+	{
+		const auto& tok = tokens[i];
+		const auto ref = tok.kind == CXToken_Identifier ? FindMacro(tok.spelling) : SIZE_MAX;
 
-	if (!parser.compile(def->GetValue(), expression))
+		// a define is not expanded again inside its own expansion
+		if (ref == SIZE_MAX || m_macros[ref].state != MacroState::Resolved || std::find(active.begin(), active.end(), ref) != active.end())
+		{
+			out.push_back(tok);
+			continue;
+		}
+
+		active.push_back(ref);
+		ExpandTokens(m_macros[ref].tokens, active, out);
+		active.pop_back();
+	}
+}
+
+void CH2Parser::EvalDefine(Define* def, const TokenSlice& tokens)
+{
+	// the referenced defines are expanded as text like the C preprocessor does
+	//  (#define A 1+2, A*3 is 7 and not 9)
+	std::vector<CachedToken> expanded;
+	std::vector<size_t> active;
+
+	expanded.reserve(tokens.size());
+	ExpandTokens(tokens, active, expanded);
+
+	// after the expansion an identifier is not a constant
+	MacroEval eval(nullptr);
+	MacroValue res;
+
+	if (!eval.Eval(expanded.data(), expanded.data() + expanded.size(), res))
 	{
-		m_lasterr = CH2ErrorCodes::EvalError;
+		// not an integer constant expression (floats, casts, sizeof...)
+		if (def->m_defType != DefineType::Float || !is_decimal_value(def, tokens))
+		{
+			def->m_defType = DefineType::Text;
+			def->m_value = JoinTokens(tokens, 1);
+		}
+
 		return;
 	}
 
-	auto res = expression.value();
+	SetDefineNumber(def, res.value, res.is_unsigned);
+
+	// keep the expression so the drivers can write it as a reference to other defines
+	for (size_t i = 1; i < tokens.size(); i++)
+	{
+		switch (tokens[i].kind)
+		{
+		case CXToken_Literal:
+		{
+			MacroValue v;
+			MacroEval::ParseLiteral(tokens[i].spelling, v);
+
+			DefineToken tok(DefineTokenType::Number);
+			tok.text = tokens[i].spelling;
+			tok.number = v.value;
+			def->m_expr.push_back(std::move(tok));
+			break;
+		}
+		case CXToken_Identifier:
+		{
+			DefineToken tok(DefineTokenType::Reference);
+			tok.text = tokens[i].spelling;
+			tok.ref = m_macros[FindMacro(tokens[i].spelling)].def;
+			def->m_expr.push_back(std::move(tok));
+			break;
+		}
+		default:
+		{
+			DefineToken tok(DefineTokenType::Operator);
+			tok.text = tokens[i].spelling;
+			def->m_expr.push_back(std::move(tok));
+			break;
+		}
+		}
+	}
+}
+
+void CH2Parser::SetDefineNumber(Define* def, uint64_t value, bool is_unsigned)
+{
+	def->m_number = value;
+	def->m_unsigned = is_unsigned;
+	def->m_hasNumber = true;
 
 	std::stringstream stream;
 
-	if (def->GetDefineType() == DefineType::Float)
-		stream << res;
+	if (MacroValue(value, is_unsigned).IsNegative())
+	{
+		stream << static_cast<int64_t>(value);
+		def->m_defType = DefineType::Integer;
+	}
 	else
-		stream << std::hex << uint32_t(res);
+	{
+		stream << std::hex << value;
+		def->m_defType = DefineType::Hexadecimal;
+	}
 
-	def->m_defType = DefineType::Hexadecimal;
 	def->m_value = stream.str();
 }
+
+/**
+* Checks if the tokens of a define can be safely placed inside an enum declaration
+* @param tokens Tokens of the define (including the name)
+* @return true if the define can be probed, otherwise false
+*/
+static bool can_probe(const TokenSlice& tokens)
+{
+	int depth = 0;
+
+	for (size_t i = 1; i < tokens.size(); i++)
+	{
+		const auto& tok = tokens[i];
+
+		if (tok.kind == CXToken_Literal && (tok.spelling[0] == '"' || tok.spelling.back() == '"'))
+			return false;
+
+		if (tok.kind != CXToken_Punctuation)
+			continue;
+
+		const auto p = tok.spelling;
+
+		if (p == "(" || p == "[")
+			depth++;
+		else if (p == ")" || p == "]")
+			depth--;
+		else if (p == "{" || p == "}" || p == ";" || p == "#" || p == "##")
+			return false; // this would break the declarations of the other probes
+
+		if (depth < 0)
+			return false;
+	}
+
+	return depth == 0;
+}
+
+/** prefix of the probe constants */
+static constexpr std::string_view g_probe_prefix = "__ch2inc_probe_";
+
+/** number of lines of a single probe */
+static constexpr unsigned g_probe_lines = 3;
+
+void CH2Parser::ProbeMacros(const std::string& in, int clang_argc, const char** clang_argv)
+{
+	std::vector<size_t> probes;
+
+	for (size_t i = 0; i < m_macros.size(); i++)
+	{
+		const auto& node = m_macros[i];
+
+		// the probe sees the last definition of the macro, we only keep the first
+		if (node.state != MacroState::Resolved || node.def->GetDefineType() != DefineType::Text ||
+			m_redefined.find(node.def->GetName()) != m_redefined.end() || !can_probe(node.tokens))
+			continue;
+
+		probes.push_back(i);
+	}
+
+	if (!probes.empty())
+		ParseProbes(in, clang_argc, clang_argv, probes);
+
+	// the definitions with keywords are supported only if they have been evaluated
+	for (auto& node : m_macros)
+	{
+		if (node.probe && node.state == MacroState::Resolved && !node.def->HasNumber())
+			node.state = MacroState::Dropped;
+	}
+}
+
+void CH2Parser::ParseProbes(const std::string& in, int clang_argc, const char** clang_argv, const std::vector<size_t>& probes)
+{
+	/*
+	* The probe file includes the input and declares a constant for each macro, every probe
+	*  takes exactly g_probe_lines lines so an error can be mapped back to its macro.
+	* The file is only passed to clang as an unsaved file, nothing is written on the disk. Its path is
+	*  next to the input so the relative includes still work, and it keeps the extension of the input
+	*  so it's parsed in the same language (eg: a .hpp is C++).
+	*/
+	const std::filesystem::path input(in);
+	const auto probe_name = (input.parent_path() / (std::string(g_probe_prefix) + input.filename().string())).string();
+
+	std::string source = "#include \"" + input.filename().string() + "\"\n";
+
+	for (size_t i = 0; i < probes.size(); i++)
+	{
+		const auto& name = m_macros[probes[i]].def->GetName();
+
+		source += "#ifdef " + name + "\n";
+		source += "static const __typeof__((" + name + ")) " + std::string(g_probe_prefix) + std::to_string(i) + " = (" + name + ");\n";
+		source += "#endif\n";
+	}
+
+	auto index = clang_createIndex(0, 0);
+
+	if (!index)
+		return;
+
+	CXUnsavedFile unsaved = {};
+	unsaved.Filename = probe_name.c_str();
+	unsaved.Contents = source.c_str();
+	unsaved.Length = static_cast<unsigned long>(source.size());
+
+	CXTranslationUnit unit = nullptr;
+	const auto ec = clang_parseTranslationUnit2(index, probe_name.c_str(), clang_argv, clang_argc,
+		&unsaved, 1,
+		CXTranslationUnit_SkipFunctionBodies | CXTranslationUnit_KeepGoing,
+		&unit);
+
+	if (ec != CXError_Success)
+	{
+		// the macros keep their text value
+		clang_disposeIndex(index);
+		return;
+	}
+
+	// clang recovers from most of the errors, so a probe with an error is never trusted
+	std::vector<bool> failed(probes.size(), false);
+	const auto ndiags = clang_getNumDiagnostics(unit);
+
+	for (unsigned i = 0; i < ndiags; i++)
+	{
+		auto diag = clang_getDiagnostic(unit, i);
+
+		if (clang_getDiagnosticSeverity(diag) >= CXDiagnostic_Error)
+		{
+			const auto loc = clang_getDiagnosticLocation(diag);
+			unsigned line = 0;
+
+			clang_getExpansionLocation(loc, nullptr, &line, nullptr, nullptr);
+
+			if (clang_Location_isFromMainFile(loc) && line > 1)
+			{
+				const auto id = (line - 2) / g_probe_lines;
+
+				if (id < failed.size())
+					failed[id] = true;
+			}
+		}
+
+		clang_disposeDiagnostic(diag);
+	}
+
+	/**
+	* Values read from the probe translation unit
+	*/
+	struct ProbeData
+	{
+		/** value of each probe */
+		std::vector<std::pair<size_t, MacroValue>> values;
+	} data;
+
+	clang_visitChildren(clang_getTranslationUnitCursor(unit), [](CXCursor c, CXCursor, CXClientData client)
+		-> CXChildVisitResult {
+			if (clang_getCursorKind(c) != CXCursor_VarDecl || !clang_Location_isFromMainFile(clang_getCursorLocation(c)))
+				return CXChildVisit_Continue;
+
+			ClangStr name(clang_getCursorSpelling(c));
+
+			if (std::string_view(name.Get()).substr(0, g_probe_prefix.size()) != g_probe_prefix)
+				return CXChildVisit_Continue;
+
+			auto res = clang_Cursor_Evaluate(c);
+
+			if (!res)
+				return CXChildVisit_Continue;
+
+			// only integer constants are supported
+			if (clang_EvalResult_getKind(res) == CXEval_Int)
+			{
+				auto& data = *static_cast<ProbeData*>(client);
+				const auto id = strtoull(name.Get() + g_probe_prefix.size(), nullptr, 10);
+				const bool is_unsigned = clang_EvalResult_isUnsignedInt(res) != 0;
+				const auto value = is_unsigned ? clang_EvalResult_getAsUnsigned(res)
+					: static_cast<uint64_t>(clang_EvalResult_getAsLongLong(res));
+
+				data.values.emplace_back(static_cast<size_t>(id), MacroValue(value, is_unsigned));
+			}
+
+			clang_EvalResult_dispose(res);
+			return CXChildVisit_Continue;
+		}, &data);
+
+	for (const auto& v : data.values)
+	{
+		if (v.first >= probes.size() || failed[v.first])
+			continue;
+
+		SetDefineNumber(m_macros[probes[v.first]].def, v.second.value, v.second.is_unsigned);
+	}
+
+	clang_disposeTranslationUnit(unit);
+	clang_disposeIndex(index);
+}
@@ -0,0 +1,161 @@
+/**
+* @file ch2parser_layout.cpp
+* @author lakor64
+* @date 18/10/2026
+* @brief structure layout code
+*/
+#include "ch2parser.hpp"
+
+#include <algorithm>
+
+/**
+* Rounds a number of bits to the smallest storage unit that contains them
+* @param bits Number of bits
+* @return 8, 16, 32 or 64 bits, or the bits rounded to bytes if they are more than 64
+*/
+static int64_t round_storage(int64_t bits)
+{
+	int64_t size = 8;
+
+	while (size < bits && size < 64)
+		size *= 2;
+
+	return bits > size ? (bits + 7) / 8 * 8 : size;
+}
+
+/**
+* Gets the end of a layout entry
+* @param e Layout entry
+* @return Offset of the first bit after the entry, -1 if the offset is unknown
+*/
+static int64_t layout_end(const LayoutEntry& e)
+{
+	return e.offset >= 0 ? e.offset + e.size : -1;
+}
+
+void CH2Parser::AddFieldLayout(Struct* s, const StructField* f, int64_t storage)
+{
+	auto& layout = s->m_layout;
+	const auto idx = static_cast<uint32_t>(s->m_fields.size() - 1);
+	const auto offset = f->GetOffset();
+
+	if (!f->IsBitField())
+	{
+		layout.push_back({ LayoutEntryType::Field, offset, storage, idx, 1 });
+		return;
+	}
+
+	const auto width = f->GetSize();
+
+	// a zero width bitfield only moves the next bitfield to a new unit, the offsets already say that
+	if (width == 0)
+		return;
+
+	// the fields of an union overlaps
+	const auto sequential = !layout.empty() && s->GetTypeID() != MemberType::Union;
+
+	if (sequential && offset >= 0)
+	{
+		auto& last = layout.back();
+
+		if (last.type == LayoutEntryType::BitGroup && last.offset >= 0)
+		{
+			const auto prev = s->m_fields[last.first + last.count - 1];
+			const auto prev_end = prev->GetOffset() + prev->GetSize();
+			const auto unit_end = last.offset + last.size;
+
+			if (offset >= prev_end && offset < unit_end)
+			{
+				// a packed bitfield can cross the end of the unit, the group grows to cover it
+				//  (FinishLayouts shrinks it again if it overlaps the next entry)
+				if (offset + width > unit_end)
+					last.size = round_storage(offset + width - last.offset);
+
+				// the bitfield continues the current storage unit
+				last.count++;
+				return;
+			}
+		}
+	}
+
+	int64_t unit = -1;
+	int64_t size = storage;
+
+	if (offset >= 0 && storage > 0)
+	{
+		unit = offset - offset % storage;
+
+		// packed bitfields can cross the natural unit of the type or start inside the previous entry,
+		//  the group starts at the byte of the bitfield and covers only its bits
+		if (offset + width > unit + storage || (sequential && unit < layout_end(layout.back())))
+		{
+			unit = offset - offset % 8;
+			size = round_storage(offset + width - unit);
+		}
+	}
+
+	layout.push_back({ LayoutEntryType::BitGroup, unit, size, idx, 1 });
+}
+
+void CH2Parser::FinishLayouts()
+{
+	for (const auto& m : m_cf->m_types)
+	{
+		// the fields of an union overlaps
+		if (m->GetTypeID() != MemberType::Struct)
+			continue;
+
+		auto s = dynamic_cast<Struct*>(m);
+		auto& layout = s->m_layout;
+		std::vector<LayoutEntry> out;
+		int64_t end = 0;
+
+		out.reserve(layout.size());
+
+		// a group of packed bitfields can be larger than the space left before the next entry
+		//  or the end of the structure, it's reduced to the bytes that are really available
+		for (size_t i = 0; i < layout.size(); i++)
+		{
+			auto& e = layout[i];
+
+			if (e.type != LayoutEntryType::BitGroup || e.offset < 0)
+				continue;
+
+			auto limit = s->m_size;
+
+			for (auto k = i + 1; k < layout.size(); k++)
+			{
+				if (layout[k].offset >= 0)
+				{
+					limit = layout[k].offset;
+					break;
+				}
+			}
+
+			if (e.offset + e.size <= limit)
+				continue;
+
+			const auto last = s->m_fields[e.first + e.count - 1];
+			const auto covered = last->GetOffset() + last->GetSize() - e.offset;
+
+			e.size = std::max(limit - e.offset, (covered + 7) / 8 * 8);
+		}
+
+		for (const auto& e : layout)
+		{
+			if (e.offset > end)
+				out.push_back({ LayoutEntryType::Padding, end, e.offset - end, e.first, 0 });
+
+			out.push_back(e);
+
+			if (e.offset >= 0)
+				end = std::max(end, e.offset + e.size);
+		}
+
+		if (s->m_size > end && !layout.empty())
+			out.push_back({ LayoutEntryType::Padding, end, s->m_size - end, static_cast<uint32_t>(s->m_fields.size()), 0 });
+
+		if (out.size() != layout.size())
+			layout = std::move(out);
+	}
+}
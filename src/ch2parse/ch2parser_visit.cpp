@@ -12,6 +12,7 @@
 #include "globalvar.hpp"
 #include "define.hpp"
 #include "clangutils.hpp"
+#include "stats.hpp"
 
 BasicMember* CH2Parser::VisitStructOrUnion(CXCursor c, bool isUnion)
 {
@@ -105,8 +106,19 @@ BasicMember* CH2Parser::VisitField(CXCursor c, CXCursor p)
 	}
 
 	rt->m_size = clang_getFieldDeclBitWidth(c);
+	rt->m_offset = m_cfg.layout ? clang_Cursor_getOffsetOfField(c) : -1; // negative in case of error
 	rt->m_parent->m_fields.emplace_back(rt);
 
+	if (rt->m_offset < 0)
+		rt->m_offset = -1;
+
+	// the layout is only built for the drivers that use it
+	if (m_cfg.layout)
+	{
+		const auto storage = clang_Type_getSizeOf(type);
+		AddFieldLayout(rt->m_parent, rt, storage > 0 ? storage * 8 : 0);
+	}
+
 	return rt;
 }
 
@@ -214,6 +226,24 @@ BasicMember* CH2Parser::VisitEnum(CXCursor c)
 	return rt;
 }
 
+void CH2Parser::AliasEnum(CXCursor c)
+{
+	ClangStr name(clang_getTypeSpelling(clang_getCursorType(c)));
+	std::string enumName = name.Get();
+	RemoveCPrefix(enumName);
+
+	auto type = m_prims->Find(clang_getEnumDeclIntegerType(c).kind);
+
+	if (!type)
+	{
+		m_lasterr = CH2ErrorCodes::MissingType;
+		return;
+	}
+
+	// the primitive is only referenced, it's not owned by the name
+	m_types.emplace(enumName, type);
+}
+
 BasicMember* CH2Parser::VisitFunc(CXCursor c)
 {
 	return VisitFunc(c, clang_getCursorType(c), false);
@@ -294,148 +324,33 @@ BasicMember* CH2Parser::VisitVarDecl(CXCursor c)
 
 BasicMember* CH2Parser::VisitMacroDef(CXCursor c)
 {
-	auto rt = new Define();
+	const auto tokens = m_tokens.Get(clang_getCursorExtent(c));
 
-	CXSourceRange range = clang_getCursorExtent(c);
+	if (tokens.empty())
+		return nullptr;
 
-	unsigned int numTokens = 0;
-	CXToken* tokens = nullptr;
-	clang_tokenize(m_unit, range, &tokens, &numTokens);
+	CH2_STAT(MacrosTokenized);
 
-	ClangStr name(clang_getCursorSpelling(c));
-	rt->m_name = name.Get();
-	bool eval = false;
+	// only the first definition is used
+	// primitives can be defined too (eg: wchar_t in C)
+	const auto other = FindType(std::string(tokens[0].spelling));
 
-	for (auto i = 0U; i < numTokens; i++)
+	if (other)
 	{
-		if (i == 0)
-			continue; // skip name
+		if (other->GetTypeID() == MemberType::Define)
+			m_redefined.insert(other->GetName());
 
-		auto kind = clang_getTokenKind(tokens[i]);
-		ClangStr value(clang_getTokenSpelling(m_unit, tokens[i]));
-		std::string value_str = value.Get();
-
-		switch (kind)
-		{
-		case CXToken_Punctuation:
-			if (rt->m_defType == DefineType::Hexadecimal || rt->m_defType == DefineType::Integer || rt->m_defType == DefineType::Octal
-				|| rt->m_defType == DefineType::Binary || rt->m_defType == DefineType::Float)
-			{
-				if (value_str == "+" || value_str == "-" || value_str == "*" || value_str == "/")
-					eval = true;
-			}
-			else if (rt->m_defType == DefineType::Text && value_str == "(") // not supported, sorry
-			{
-				clang_disposeTokens(m_unit, tokens, numTokens);
-				delete rt;
-				return nullptr;
-			}
-
-			rt->m_value += value_str;
-			break;
-		case CXToken_Identifier:
-		{
-			const auto& ref = FindType(value_str);
-
-			if (!ref || ref->GetTypeID() != MemberType::Define)
-			{
-				rt->m_value += value_str;
-				rt->m_defType = DefineType::Text;
-				continue;
-			}
-			else
-			{
-				const auto& dd = dynamic_cast<Define*>(ref);
-				rt->m_value += dd->GetValue();
-
-				if (rt->m_defType == DefineType::None)
-					rt->m_defType = dd->GetDefineType();
-
-				if (dd->GetDefineType() != rt->m_defType)
-					rt->m_defType = DefineType::Text;
-			}
-			break;
-		}
-		case CXToken_Literal:
-		{
-			auto last_ch = rt->m_value[rt->m_value.size() - 1];
-			if (last_ch == '-' || last_ch == '~')
-				eval = true;
-
-			// does the token starts with a string literal?
-			if (value_str[0] == '"')
-			{
-				rt->m_defType = DefineType::String;
-
-				const auto e = value_str.find_last_of('"');
-				if (e == std::string::npos)
-				{
-					// invalid string
-					m_lasterr = CH2ErrorCodes::ValueError;
-					clang_disposeTokens(m_unit, tokens, numTokens);
-					delete rt;
-					return nullptr;
-				}
-
-				value_str = value_str.substr(1, e - 1);
-				rt->m_value += value_str;
-			}
-			else if (isdigit(value_str[0]))
-			{
-				// we might have an int literal
-
-				if (value_str[0] == '0' && value_str[1] == 'x')
-				{
-					rt->m_defType = DefineType::Hexadecimal;
-					value_str = value_str.substr(2);
-				}
-				else if (value_str[0] == '0' && value_str[1] == 'b')
-				{
-					rt->m_defType = DefineType::Binary;
-					value_str = value_str.substr(2);
-				}
-				else if (value_str[0] == '0' && value_str.size() > 1)
-				{
-					rt->m_defType = DefineType::Octal;
-					value_str = value_str.substr(1);
-				}
-				else
-					rt->m_defType = DefineType::Integer;
-
-				if (value_str.find(".") != std::string::npos || value_str[value_str.size() - 1] == 'f')
-					rt->m_defType = DefineType::Float;
-
-				size_t m = 0;
-				for (; m < value_str.size(); m++)
-				{
-					if (!isdigit(value_str[m]) && value_str[m] != '.')
-						break;
-				}
-
-				// remove ULL and similar marks
-				value_str = value_str.substr(0, m);
-
-				rt->m_value += value_str;
-			}
-			else if (rt->m_defType == DefineType::None)
-			{
-				clang_disposeTokens(m_unit, tokens, numTokens);
-				delete rt;
-				return nullptr;
-			}
-			break;
-		}
-		default:
-			clang_disposeTokens(m_unit, tokens, numTokens);
-			delete rt;
-			return nullptr;
-		}
+		return nullptr;
 	}
 
-	clang_disposeTokens(m_unit, tokens, numTokens);
+	auto rt = new Define();
+	rt->m_name = tokens[0].spelling;
 
-	if (eval)
-		EvalDefine(rt);
+	/*
+	* The value is resolved after the visit, so every definition is evaluated only once and
+	*  a definition can reference the ones that are declared after it
+	*/
+	m_macros.push_back({ rt, tokens, MacroState::Pending, false });
 
 	return rt;
 }
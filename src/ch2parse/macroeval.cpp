@@ -0,0 +1,439 @@
+/**
+* @file macroeval.cpp
+* @author lakor64
+* @date 18/10/2026
+* @brief C preprocessor integer expression evaluator
+*/
+#include "macroeval.hpp"
+
+#include <cctype>
+#include <limits>
+
+/**
+* Binary operators sorted by precedence (lowest first)
+*/
+static constexpr std::string_view g_binops[][2] = {
+	{ "||", "" },
+	{ "&&", "" },
+	{ "|", "" },
+	{ "^", "" },
+	{ "&", "" },
+	{ "==", "!=" },
+	{ "<", ">" },
+	{ "<<", ">>" },
+	{ "+", "-" },
+	{ "*", "/" },
+};
+
+/** number of precedence levels */
+static constexpr int g_maxprec = static_cast<int>(sizeof(g_binops) / sizeof(g_binops[0]));
+
+/**
+* Gets the numeric value of a digit
+* @param c Digit character
+* @return Value of the digit or -1 if it's not a digit
+*/
+static int digit_value(char c)
+{
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+
+	return -1;
+}
+
+/**
+* Parses a character literal
+* @param str Literal to parse (with the prefix)
+* @param out Value of the literal
+* @return true if the literal is valid
+*/
+static bool parse_char_literal(std::string_view str, MacroValue& out)
+{
+	bool wide = false;
+
+	while (!str.empty() && str[0] != '\'')
+	{
+		wide = true; // L'x', u'x', U'x', u8'x'
+		str.remove_prefix(1);
+	}
+
+	if (str.size() < 3 || str.back() != '\'')
+		return false;
+
+	str = str.substr(1, str.size() - 2);
+
+	uint64_t v = 0;
+
+	if (str[0] != '\\')
+	{
+		if (str.size() != 1)
+			return false; // multi-character constants are implementation defined
+
+		v = static_cast<unsigned char>(str[0]);
+	}
+	else if (str.size() == 2)
+	{
+		switch (str[1])
+		{
+		case 'n': v = '\n'; break;
+		case 't': v = '\t'; break;
+		case 'r': v = '\r'; break;
+		case 'a': v = '\a'; break;
+		case 'b': v = '\b'; break;
+		case 'f': v = '\f'; break;
+		case 'v': v = '\v'; break;
+		case '\\': v = '\\'; break;
+		case '\'': v = '\''; break;
+		case '"': v = '"'; break;
+		case '?': v = '?'; break;
+		default:
+			if (str[1] < '0' || str[1] > '7')
+				return false;
+
+			v = str[1] - '0';
+			break;
+		}
+	}
+	else
+	{
+		const int base = str[1] == 'x' ? 16 : 8;
+		const size_t start = base == 16 ? 2 : 1;
+
+		if (start >= str.size())
+			return false;
+
+		for (size_t i = start; i < str.size(); i++)
+		{
+			const auto d = digit_value(str[i]);
+			if (d < 0 || d >= base)
+				return false;
+
+			v = v * base + d;
+		}
+	}
+
+	// plain char is signed
+	if (!wide && v < 0x100)
+		v = static_cast<uint64_t>(static_cast<int64_t>(static_cast<signed char>(v)));
+
+	out = MacroValue(v, false);
+	return true;
+}
+
+bool MacroEval::ParseLiteral(std::string_view str, MacroValue& out)
+{
+	if (str.empty())
+		return false;
+
+	if (!isdigit(static_cast<unsigned char>(str[0])))
+		return parse_char_literal(str, out);
+
+	int base = 10;
+	size_t i = 0;
+
+	if (str.size() > 1 && str[0] == '0' && (str[1] == 'x' || str[1] == 'X'))
+	{
+		base = 16;
+		i = 2;
+	}
+	else if (str.size() > 1 && str[0] == '0' && (str[1] == 'b' || str[1] == 'B'))
+	{
+		base = 2;
+		i = 2;
+	}
+	else if (str[0] == '0')
+	{
+		base = 8;
+	}
+
+	uint64_t v = 0;
+	size_t digits = 0;
+
+	for (; i < str.size(); i++)
+	{
+		if (str[i] == '\'') // digit separator
+			continue;
+
+		const auto d = digit_value(str[i]);
+		if (d < 0 || d >= base)
+			break;
+
+		if (v > (std::numeric_limits<uint64_t>::max() - d) / base)
+			return false; // does not fit in 64-bit
+
+		v = v * base + d;
+		digits++;
+	}
+
+	if (digits == 0 && base != 8)
+		return false;
+
+	// suffixes (u, l, ll and the MSVC i8/i16/i32/i64)
+	bool is_unsigned = false;
+	auto suffix = str.substr(i);
+
+	while (!suffix.empty())
+	{
+		if (suffix[0] == 'u' || suffix[0] == 'U')
+		{
+			is_unsigned = true;
+			suffix.remove_prefix(1);
+		}
+		else if (suffix[0] == 'l' || suffix[0] == 'L')
+		{
+			suffix.remove_prefix(1);
+		}
+		else if (suffix[0] == 'i' || suffix[0] == 'I')
+		{
+			suffix.remove_prefix(1);
+
+			while (!suffix.empty() && isdigit(static_cast<unsigned char>(suffix[0])))
+				suffix.remove_prefix(1);
+		}
+		else
+			return false; // floating point or invalid literal
+	}
+
+	// a literal that does not fit in intmax_t is unsigned
+	if (v > static_cast<uint64_t>(std::numeric_limits<int64_t>::max()))
+		is_unsigned = true;
+
+	out = MacroValue(v, is_unsigned);
+	return true;
+}
+
+bool MacroEval::Peek(std::string_view p) const
+{
+	return m_cur != m_end && m_cur->kind == CXToken_Punctuation && m_cur->spelling == p;
+}
+
+bool MacroEval::Eval(const CachedToken* first, const CachedToken* last, MacroValue& out)
+{
+	m_cur = first;
+	m_end = last;
+	m_skip = 0;
+	m_ok = true;
+
+	if (m_cur == m_end)
+		return false;
+
+	out = Conditional();
+
+	// every token must be consumed
+	return m_ok && m_cur == m_end;
+}
+
+MacroValue MacroEval::Conditional()
+{
+	const auto c = Binary(0);
+
+	if (!m_ok || !Peek("?"))
+		return c;
+
+	m_cur++;
+	const bool cond = c.value != 0;
+
+	if (!cond)
+		m_skip++;
+
+	const auto a = Conditional();
+
+	if (!cond)
+		m_skip--;
+
+	if (!Peek(":"))
+		return Fail();
+
+	m_cur++;
+
+	if (cond)
+		m_skip++;
+
+	const auto b = Conditional();
+
+	if (cond)
+		m_skip--;
+
+	return MacroValue(cond ? a.value : b.value, a.is_unsigned || b.is_unsigned);
+}
+
+MacroValue MacroEval::Binary(int prec)
+{
+	if (prec >= g_maxprec)
+		return Unary();
+
+	auto lhs = Binary(prec + 1);
+
+	while (m_ok && m_cur != m_end && m_cur->kind == CXToken_Punctuation)
+	{
+		const auto op = m_cur->spelling;
+		const auto& ops = g_binops[prec];
+
+		// relational operators share the level with their "or equal" version, % with * and /
+		const bool match = op == ops[0] || (!ops[1].empty() && op == ops[1])
+			|| (prec == 6 && (op == "<=" || op == ">="))
+			|| (prec == 9 && op == "%");
+
+		if (!match)
+			break;
+
+		m_cur++;
+
+		// short circuit
+		const bool skip = (op == "&&" && lhs.value == 0) || (op == "||" && lhs.value != 0);
+
+		if (skip)
+			m_skip++;
+
+		const auto rhs = Binary(prec + 1);
+
+		if (skip)
+			m_skip--;
+
+		if (!m_ok)
+			break;
+
+		lhs = Apply(op, lhs, rhs);
+	}
+
+	return lhs;
+}
+
+MacroValue MacroEval::Apply(std::string_view op, const MacroValue& a, const MacroValue& b)
+{
+	const bool u = a.is_unsigned || b.is_unsigned;
+	const auto sa = static_cast<int64_t>(a.value);
+	const auto sb = static_cast<int64_t>(b.value);
+
+	if (op == "||")
+		return MacroValue(a.value != 0 || b.value != 0);
+	if (op == "&&")
+		return MacroValue(a.value != 0 && b.value != 0);
+	if (op == "|")
+		return MacroValue(a.value | b.value, u);
+	if (op == "^")
+		return MacroValue(a.value ^ b.value, u);
+	if (op == "&")
+		return MacroValue(a.value & b.value, u);
+	if (op == "==")
+		return MacroValue(a.value == b.value);
+	if (op == "!=")
+		return MacroValue(a.value != b.value);
+	if (op == "<")
+		return MacroValue(u ? a.value < b.value : sa < sb);
+	if (op == ">")
+		return MacroValue(u ? a.value > b.value : sa > sb);
+	if (op == "<=")
+		return MacroValue(u ? a.value <= b.value : sa <= sb);
+	if (op == ">=")
+		return MacroValue(u ? a.value >= b.value : sa >= sb);
+	if (op == "+")
+		return MacroValue(a.value + b.value, u);
+	if (op == "-")
+		return MacroValue(a.value - b.value, u);
+	if (op == "*")
+		return MacroValue(a.value * b.value, u);
+
+	if (op == "<<" || op == ">>")
+	{
+		// the result has the type of the left operand
+		if ((!b.is_unsigned && sb < 0) || b.value >= 64)
+			return m_skip ? MacroValue() : Fail();
+
+		if (op == "<<")
+			return MacroValue(a.value << b.value, a.is_unsigned);
+
+		if (a.is_unsigned)
+			return MacroValue(a.value >> b.value, true);
+
+		return MacroValue(static_cast<uint64_t>(sa >> b.value), false);
+	}
+
+	// division and modulo
+	if (b.value == 0 || (!u && sa == std::numeric_limits<int64_t>::min() && sb == -1))
+		return m_skip ? MacroValue() : Fail();
+
+	if (op == "/")
+		return u ? MacroValue(a.value / b.value, true) : MacroValue(static_cast<uint64_t>(sa / sb), false);
+
+	return u ? MacroValue(a.value % b.value, true) : MacroValue(static_cast<uint64_t>(sa % sb), false);
+}
+
+MacroValue MacroEval::Unary()
+{
+	if (m_cur == m_end)
+		return Fail();
+
+	if (m_cur->kind == CXToken_Punctuation)
+	{
+		const auto op = m_cur->spelling;
+
+		if (op == "+" || op == "-" || op == "~" || op == "!")
+		{
+			m_cur++;
+			const auto v = Unary();
+
+			if (op == "-")
+				return MacroValue(0 - v.value, v.is_unsigned);
+			if (op == "~")
+				return MacroValue(~v.value, v.is_unsigned);
+			if (op == "!")
+				return MacroValue(v.value == 0);
+
+			return v;
+		}
+	}
+
+	return Primary();
+}
+
+MacroValue MacroEval::Primary()
+{
+	if (m_cur == m_end)
+		return Fail();
+
+	const auto& tok = *m_cur;
+	m_cur++;
+
+	switch (tok.kind)
+	{
+	case CXToken_Literal:
+	{
+		MacroValue v;
+		if (!ParseLiteral(tok.spelling, v))
+			return Fail();
+
+		return v;
+	}
+	case CXToken_Identifier:
+	{
+		MacroValue v;
+		if (!m_resolver || !m_resolver(tok.spelling, v))
+			return Fail();
+
+		return v;
+	}
+	case CXToken_Punctuation:
+	{
+		if (tok.spelling != "(")
+			break;
+
+		const auto v = Conditional();
+
+		if (!m_ok || !Peek(")"))
+			return Fail();
+
+		m_cur++;
+		return v;
+	}
+	default:
+		break;
+	}
+
+	// keywords (sizeof, casts) and unsupported punctuation
+	return Fail();
+}
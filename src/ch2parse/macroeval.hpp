@@ -0,0 +1,118 @@
+/**
+* @file macroeval.hpp
+* @author lakor64
+* @date 18/10/2026
+* @brief C preprocessor integer expression evaluator
+*/
+#pragma once
+
+#include "tokencache.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <string_view>
+
+/**
+* Value of an integer expression
+*/
+struct MacroValue
+{
+	/**
+	* Default constructor
+	*/
+	explicit MacroValue(uint64_t v = 0, bool u = false) : value(v), is_unsigned(u) {}
+
+	/** bits of the value (two's complement if signed) */
+	uint64_t value;
+	/** if the value has an unsigned type */
+	bool is_unsigned;
+
+	/**
+	* Checks if the value is a negative signed number
+	* @return true if the value is negative, otherwise false
+	*/
+	constexpr bool IsNegative() const { return !is_unsigned && static_cast<int64_t>(value) < 0; }
+};
+
+/**
+* Evaluates C preprocessor integer expressions directly from the token stream.
+* The evaluation follows the rules of #if: every value is either intmax_t or uintmax_t (64-bit)
+* and an operation is unsigned if any of the operands is unsigned.
+*/
+class MacroEval final
+{
+public:
+	/**
+	* Callback used to get the value of an identifier
+	* @param name Identifier name
+	* @param out Value of the identifier
+	* @return true if the identifier was resolved, otherwise false
+	*/
+	using Resolver = std::function<bool(std::string_view name, MacroValue& out)>;
+
+	/**
+	* Default constructor
+	* @param resolver Identifier resolver
+	*/
+	explicit MacroEval(Resolver resolver) : m_resolver(std::move(resolver)), m_cur(nullptr), m_end(nullptr), m_skip(0), m_ok(true) {}
+
+	/**
+	* Evaluates an expression
+	* @param first First token of the expression
+	* @param last End of the expression
+	* @param out Result of the expression
+	* @return true if the expression was evaluated, otherwise false
+	*/
+	bool Eval(const CachedToken* first, const CachedToken* last, MacroValue& out);
+
+	/**
+	* Parses an integer or character literal
+	* @param str Literal to parse
+	* @param out Value of the literal
+	* @return true if the literal is a valid integer literal, otherwise false
+	*/
+	static bool ParseLiteral(std::string_view str, MacroValue& out);
+
+private:
+	/** conditional operator (a ? b : c) */
+	MacroValue Conditional();
+	/** binary operators by precedence */
+	MacroValue Binary(int prec);
+	/** unary operators */
+	MacroValue Unary();
+	/** literals, identifiers and parenthesis */
+	MacroValue Primary();
+
+	/**
+	* Applies a binary operator
+	* @param op Operator spelling
+	* @param a Left operand
+	* @param b Right operand
+	* @return Result of the operation
+	*/
+	MacroValue Apply(std::string_view op, const MacroValue& a, const MacroValue& b);
+
+	/**
+	* Checks if the current token is the specified punctuation
+	* @param p Punctuation to check
+	* @return true if the token matches, otherwise false
+	*/
+	bool Peek(std::string_view p) const;
+
+	/**
+	* Signals an evaluation error
+	* @return Empty value
+	*/
+	MacroValue Fail() { m_ok = false; return MacroValue(); }
+
+	/** identifier resolver */
+	Resolver m_resolver;
+	/** current token */
+	const CachedToken* m_cur;
+	/** end of the tokens */
+	const CachedToken* m_end;
+	/** when > 0 the expression is only parsed (unevaluated branch of ?:, && or ||) */
+	int m_skip;
+	/** evaluation status */
+	bool m_ok;
+};
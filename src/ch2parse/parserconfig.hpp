@@ -0,0 +1,77 @@
+/**
+* @file parserconfig.hpp
+* @author lakor64
+* @date 18/10/2026
+* @brief parser configuration
+*/
+#pragma once
+
+/**
+* Preprocessor definitions to keep
+*/
+enum class MacroFilter
+{
+	/**
+	* Keep every supported definition
+	*/
+	All,
+
+	/**
+	* Keep only the integer definitions (like H2INC)
+	*/
+	Int,
+
+	/**
+	* Do not parse any definition
+	*/
+	None,
+};
+
+/**
+* Parser configuration
+*/
+struct ParserConfig
+{
+	/**
+	* Default constructor
+	*/
+	explicit ParserConfig() : probe_macros(false), fast(false), macros(MacroFilter::All), functions(true), globals(true), enums(true), layout(true) {}
+
+	/**
+	* Evaluates the macros that cannot be computed from their tokens (sizeof, casts, enum constants)
+	*  by asking clang to compile them, all the macros are evaluated with a single extra parse
+	*/
+	bool probe_macros;
+
+	/**
+	* Parses only the input file without entering the includes, this is meant for self-contained headers
+	* @note if the fast parse fails (eg: a type is declared in an include) the full parse is done
+	*/
+	bool fast;
+
+	/**
+	* Preprocessor definitions to parse, when none of them is needed the preprocessing record is not requested
+	*/
+	MacroFilter macros;
+
+	/**
+	* Parse the function declarations
+	*/
+	bool functions;
+
+	/**
+	* Parse the global variables
+	*/
+	bool globals;
+
+	/**
+	* Parse the enumerations, when disabled the enumeration types are replaced with their integer type
+	*/
+	bool enums;
+
+	/**
+	* Computes the field offsets and the structure layouts, it can be disabled
+	*  when the driver does not use them (the offsets are -1 and the layouts are empty)
+	*/
+	bool layout;
+};
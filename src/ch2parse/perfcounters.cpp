@@ -0,0 +1,125 @@
+/**
+* @file perfcounters.cpp
+* @author lakor64
+* @date 18/10/2026
+* @brief hardware performance counters
+*/
+#include "perfcounters.hpp"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+/**
+* Names of the counters
+*/
+static constexpr const char* g_perf_names[PerfCounters::Count] = {
+	"cycles",
+	"instructions",
+	"cache_misses",
+	"branch_misses",
+};
+
+#ifdef __linux__
+/**
+* perf_event_open configuration of the counters
+*/
+static constexpr uint64_t g_perf_config[PerfCounters::Count] = {
+	PERF_COUNT_HW_CPU_CYCLES,
+	PERF_COUNT_HW_INSTRUCTIONS,
+	PERF_COUNT_HW_CACHE_MISSES,
+	PERF_COUNT_HW_BRANCH_MISSES,
+};
+#endif
+
+PerfCounters::PerfCounters()
+{
+	m_fds.fill(-1);
+}
+
+PerfCounters::~PerfCounters()
+{
+#ifdef __linux__
+	for (auto fd : m_fds)
+	{
+		if (fd >= 0)
+			close(fd);
+	}
+#endif
+}
+
+const char* PerfCounters::GetName(size_t i)
+{
+	return i < Count ? g_perf_names[i] : "unknown";
+}
+
+bool PerfCounters::IsOpen() const
+{
+	for (auto fd : m_fds)
+	{
+		if (fd >= 0)
+			return true;
+	}
+
+	return false;
+}
+
+bool PerfCounters::Open()
+{
+	if (IsOpen())
+		return true;
+
+#ifdef __linux__
+	for (size_t i = 0; i < Count; i++)
+	{
+		perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.config = g_perf_config[i];
+		// only our code, this works with the default perf_event_paranoid
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		// count the threads created later too (parallel write), their counts are added when they exit
+		attr.inherit = 1;
+
+		const auto fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+
+		if (fd < 0)
+		{
+			// some counters might not exist (eg: virtual machines), keep the others
+			if (m_error.empty())
+				m_error = std::string("perf_event_open failed for ") + g_perf_names[i] + ": " + strerror(errno);
+
+			continue;
+		}
+
+		m_fds[i] = fd;
+	}
+#else
+	m_error = "hardware counters are only supported on Linux";
+#endif
+
+	return IsOpen();
+}
+
+void PerfCounters::Read(Values& out) const
+{
+	out.fill(0);
+
+#ifdef __linux__
+	for (size_t i = 0; i < Count; i++)
+	{
+		uint64_t v = 0;
+
+		if (m_fds[i] >= 0 && read(m_fds[i], &v, sizeof(v)) == sizeof(v))
+			out[i] = v;
+	}
+#endif
+}
@@ -0,0 +1,84 @@
+/**
+* @file perfcounters.hpp
+* @author lakor64
+* @date 18/10/2026
+* @brief hardware performance counters
+*/
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+/**
+* Hardware counters of the current thread and of the threads it creates after Open (cycles,
+*  instructions, cache misses and branch misses), a thread is counted once it has exited.
+* They are only supported on Linux with perf_event_open, on the other platforms or when
+*  the kernel does not allow it the counters are unavailable.
+*/
+class PerfCounters final
+{
+public:
+	/** number of counters */
+	static constexpr size_t Count = 4;
+
+	/** values of the counters, a counter that could not be opened is always 0 */
+	using Values = std::array<uint64_t, Count>;
+
+	/**
+	* Default constructor
+	*/
+	explicit PerfCounters();
+
+	/**
+	* Default deconstructor
+	*/
+	~PerfCounters();
+
+	PerfCounters(const PerfCounters&) = delete;
+	PerfCounters& operator=(const PerfCounters&) = delete;
+
+	/**
+	* Opens the counters
+	* @return true if at least one counter is available, otherwise false
+	*/
+	bool Open();
+
+	/**
+	* Reads the current value of the counters
+	* @param out Values of the counters
+	*/
+	void Read(Values& out) const;
+
+	/**
+	* Checks if a counter is available
+	* @param i Index of the counter
+	* @return true if the counter was opened
+	*/
+	constexpr bool IsAvailable(size_t i) const { return m_fds[i] >= 0; }
+
+	/**
+	* Checks if any counter is available
+	* @return true if at least one counter was opened
+	*/
+	bool IsOpen() const;
+
+	/**
+	* Gets the reason why the counters are unavailable
+	* @return Error message
+	*/
+	const std::string& GetError() const { return m_error; }
+
+	/**
+	* Gets the name of a counter
+	* @param i Index of the counter
+	* @return Name of the counter
+	*/
+	static const char* GetName(size_t i);
+
+private:
+	/** file descriptors of the counters, -1 if the counter is not available */
+	std::array<int, Count> m_fds;
+	/** error of the first counter that could not be opened */
+	std::string m_error;
+};
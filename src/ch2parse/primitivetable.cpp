@@ -0,0 +1,122 @@
+/**
+* @file primitivetable.cpp
+* @author lakor64
+* @date 18/10/2026
+* @brief per-platform primitive tables
+*/
+#include "primitivetable.hpp"
+
+#include <vector>
+
+/**
+* Description of a primitive
+*/
+struct PrimitiveDesc
+{
+	/** C name of the primitive */
+	std::string_view name;
+	/** modificator of the primitive */
+	PrimitiveMods mod;
+};
+
+/**
+* Primitives indexed by PrimitiveKind
+*/
+static constexpr PrimitiveDesc g_prims[] = {
+	{ "char", PrimitiveMods::Default },
+	{ "signed char", PrimitiveMods::Signed },
+	{ "unsigned char", PrimitiveMods::Unsigned },
+	{ "short", PrimitiveMods::Default },
+	{ "unsigned short", PrimitiveMods::Unsigned },
+	{ "int", PrimitiveMods::Default },
+	{ "unsigned int", PrimitiveMods::Unsigned },
+	{ "long", PrimitiveMods::Default },
+	{ "unsigned long", PrimitiveMods::Unsigned },
+	{ "long long", PrimitiveMods::Default },
+	{ "unsigned long long", PrimitiveMods::Unsigned },
+	{ "__int128", PrimitiveMods::Default },
+	{ "unsigned __int128", PrimitiveMods::Unsigned },
+	{ "float", PrimitiveMods::Default },
+	{ "double", PrimitiveMods::Default },
+	{ "long double", PrimitiveMods::Default },
+	{ "wchar_t", PrimitiveMods::Default },
+	{ "*", PrimitiveMods::Default },
+};
+
+/** number of primitives */
+static constexpr size_t g_count = static_cast<size_t>(PrimitiveKind::Count);
+
+static_assert(sizeof(g_prims) / sizeof(g_prims[0]) == g_count, "the primitive descriptions must match PrimitiveKind");
+
+/** supported platform bits */
+static constexpr uint32_t g_bits[] = { 16, 32, 64 };
+
+/** number of platform types */
+static constexpr size_t g_platforms = static_cast<size_t>(PlatformType::OS2) + 1;
+
+/**
+* Gets the index of the table of a platform configuration
+* @param type Platform type
+* @param bits Index of the platform bits
+* @param real10 If the platform supports 10-bytes floating numbers
+* @return Index of the table
+*/
+static constexpr size_t table_index(PlatformType type, size_t bits, bool real10)
+{
+	return (static_cast<size_t>(type) * 3 + bits) * 2 + (real10 ? 1 : 0);
+}
+
+PrimitiveTable::PrimitiveTable(PlatformType type, uint32_t bits, bool real10) : m_prims(new Primitive[g_count])
+{
+	for (size_t i = 0; i < g_count; i++)
+	{
+		auto& p = m_prims[i];
+		p.m_name = g_prims[i].name;
+		p.m_type = GetType(static_cast<PrimitiveKind>(i), type, bits, real10);
+		p.m_mod = g_prims[i].mod;
+	}
+}
+
+const PrimitiveTable& PrimitiveTable::Get(const PlatformInfo& plat)
+{
+	// every configuration is built once, the initialization of a static is thread-safe
+	static const auto tables = []() {
+		std::vector<PrimitiveTable> t;
+		t.reserve(g_platforms * 3 * 2);
+
+		for (size_t type = 0; type < g_platforms; type++)
+		{
+			for (auto bits : g_bits)
+			{
+				t.emplace_back(PrimitiveTable(static_cast<PlatformType>(type), bits, false));
+				t.emplace_back(PrimitiveTable(static_cast<PlatformType>(type), bits, true));
+			}
+		}
+
+		return t;
+	}();
+
+	const auto bits = plat.GetBits() == 16 ? 0 : plat.GetBits() == 32 ? 1 : 2;
+	return tables[table_index(plat.GetType(), bits, plat.HaveReal10())];
+}
+
+Primitive* PrimitiveTable::Find(PrimitiveKind kind) const
+{
+	const auto i = static_cast<size_t>(kind);
+
+	if (i >= g_count)
+		return nullptr;
+
+	return &m_prims[i];
+}
+
+Primitive* PrimitiveTable::Find(std::string_view name) const
+{
+	for (size_t i = 0; i < g_count; i++)
+	{
+		if (g_prims[i].name == name)
+			return &m_prims[i];
+	}
+
+	return nullptr;
+}
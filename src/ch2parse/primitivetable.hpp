@@ -0,0 +1,219 @@
+/**
+* @file primitivetable.hpp
+* @author lakor64
+* @date 18/10/2026
+* @brief per-platform primitive tables
+*/
+#pragma once
+
+#include "platform.hpp"
+#include "primitive.hpp"
+
+#include <clang-c/Index.h>
+
+#include <memory>
+#include <string_view>
+
+/**
+* Primitives known by the parser
+*/
+enum class PrimitiveKind
+{
+	Char,
+	SChar,
+	UChar,
+	Short,
+	UShort,
+	Int,
+	UInt,
+	Long,
+	ULong,
+	LongLong,
+	ULongLong,
+	Int128,
+	UInt128,
+	Float,
+	Double,
+	LongDouble,
+	WChar,
+	/** generic pointer ("*") */
+	Pointer,
+	/** number of primitives */
+	Count,
+};
+
+/**
+* Primitives of a single platform configuration.
+* The tables are built once for every platform and they are shared read-only by all the parsers,
+*  the primitives must never be modified or deleted.
+*/
+class PrimitiveTable final
+{
+public:
+	/**
+	* Gets the table of a platform
+	* @param plat Platform configuration
+	* @return Shared table of the platform
+	*/
+	static const PrimitiveTable& Get(const PlatformInfo& plat);
+
+	/**
+	* Gets a primitive
+	* @param kind Primitive to get
+	* @return Primitive or NULL if the kind is invalid
+	*/
+	Primitive* Find(PrimitiveKind kind) const;
+
+	/**
+	* Gets the primitive of a clang builtin type
+	* @param kind Clang type kind
+	* @return Primitive or NULL if the type is not a supported builtin
+	*/
+	Primitive* Find(CXTypeKind kind) const { return Find(GetKind(kind)); }
+
+	/**
+	* Gets a primitive by its C name (eg: "unsigned int")
+	* @param name Name of the primitive
+	* @return Primitive or NULL if the name is not a primitive
+	*/
+	Primitive* Find(std::string_view name) const;
+
+	/**
+	* Gets the primitive of a clang builtin type
+	* @param kind Clang type kind
+	* @return Primitive kind or PrimitiveKind::Count if the type is not supported
+	*/
+	static constexpr PrimitiveKind GetKind(CXTypeKind kind)
+	{
+		switch (kind)
+		{
+		case CXType_Char_S:
+		case CXType_Char_U:
+			return PrimitiveKind::Char;
+		case CXType_SChar:
+			return PrimitiveKind::SChar;
+		case CXType_UChar:
+			return PrimitiveKind::UChar;
+		case CXType_Short:
+			return PrimitiveKind::Short;
+		case CXType_UShort:
+			return PrimitiveKind::UShort;
+		case CXType_Int:
+			return PrimitiveKind::Int;
+		case CXType_UInt:
+			return PrimitiveKind::UInt;
+		case CXType_Long:
+			return PrimitiveKind::Long;
+		case CXType_ULong:
+			return PrimitiveKind::ULong;
+		case CXType_LongLong:
+			return PrimitiveKind::LongLong;
+		case CXType_ULongLong:
+			return PrimitiveKind::ULongLong;
+		case CXType_Int128:
+			return PrimitiveKind::Int128;
+		case CXType_UInt128:
+			return PrimitiveKind::UInt128;
+		case CXType_Float:
+			return PrimitiveKind::Float;
+		case CXType_Double:
+			return PrimitiveKind::Double;
+		case CXType_LongDouble:
+			return PrimitiveKind::LongDouble;
+		case CXType_WChar:
+			return PrimitiveKind::WChar;
+		default:
+			break;
+		}
+
+		return PrimitiveKind::Count;
+	}
+
+	/**
+	* Gets the signed primitive of the specified size
+	* @param size Size in bits
+	* @return Primitive kind or PrimitiveKind::Count if there's no primitive of that size
+	*/
+	static constexpr PrimitiveKind GetKindFromSize(long long size)
+	{
+		switch (size)
+		{
+		case 8:
+			return PrimitiveKind::Char;
+		case 16:
+			return PrimitiveKind::Short;
+		case 32:
+			return PrimitiveKind::Int;
+		case 64:
+			return PrimitiveKind::LongLong;
+		case 80:
+			return PrimitiveKind::LongDouble;
+		default:
+			break;
+		}
+
+		return PrimitiveKind::Count;
+	}
+
+	/**
+	* Gets the type of a primitive for a platform
+	* @param kind Primitive
+	* @param type Platform type
+	* @param bits Platform bits
+	* @param real10 If the platform supports 10-bytes floating numbers
+	* @return Primitive type
+	*/
+	static constexpr PrimitiveType GetType(PrimitiveKind kind, PlatformType type, uint32_t bits, bool real10)
+	{
+		const bool posix = type == PlatformType::Linux || type == PlatformType::Darwin;
+
+		switch (kind)
+		{
+		case PrimitiveKind::Char:
+		case PrimitiveKind::SChar:
+		case PrimitiveKind::UChar:
+			return PrimitiveType::Byte;
+		case PrimitiveKind::Short:
+		case PrimitiveKind::UShort:
+			return PrimitiveType::Word;
+		case PrimitiveKind::Int:
+		case PrimitiveKind::UInt:
+			return bits == 16 ? PrimitiveType::Word : PrimitiveType::DWord;
+		case PrimitiveKind::Long:
+		case PrimitiveKind::ULong:
+			return posix && bits == 64 ? PrimitiveType::QWord : PrimitiveType::DWord;
+		case PrimitiveKind::LongLong:
+		case PrimitiveKind::ULongLong:
+			return PrimitiveType::QWord;
+		case PrimitiveKind::Int128:
+		case PrimitiveKind::UInt128:
+			return PrimitiveType::OWord;
+		case PrimitiveKind::Float:
+			return PrimitiveType::Real4;
+		case PrimitiveKind::Double:
+			return PrimitiveType::Real8;
+		case PrimitiveKind::LongDouble:
+			return real10 ? PrimitiveType::Real10 : PrimitiveType::Real8;
+		case PrimitiveKind::WChar:
+			return posix ? PrimitiveType::DWord : PrimitiveType::Word;
+		case PrimitiveKind::Pointer:
+			return bits == 16 ? PrimitiveType::Word : bits == 32 ? PrimitiveType::DWord : bits == 64 ? PrimitiveType::QWord : PrimitiveType::Invalid;
+		default:
+			break;
+		}
+
+		return PrimitiveType::Invalid;
+	}
+
+private:
+	/**
+	* Builds the table of a platform
+	* @param type Platform type
+	* @param bits Platform bits
+	* @param real10 If the platform supports 10-bytes floating numbers
+	*/
+	explicit PrimitiveTable(PlatformType type, uint32_t bits, bool real10);
+
+	/** primitives indexed by PrimitiveKind */
+	std::unique_ptr<Primitive[]> m_prims;
+};
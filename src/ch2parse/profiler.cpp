@@ -0,0 +1,336 @@
+/**
+* @file profiler.cpp
+* @author lakor64
+* @date 18/10/2026
+* @brief phase timing and memory report
+*/
+#include "profiler.hpp"
+#include "allocstats.hpp"
+
+#include <iomanip>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <time.h>
+#endif
+
+/**
+* Names of the phases
+*/
+static constexpr const char* g_phase_names[] = {
+	"index",
+	"parse",
+	"visit",
+	"macro",
+	"fixup",
+	"emit",
+};
+
+static_assert(sizeof(g_phase_names) / sizeof(g_phase_names[0]) == static_cast<size_t>(ProfilePhase::Count), "missing phase name");
+static_assert(static_cast<size_t>(ProfilePhase::Count) < AllocStats::NoPhase, "not enough allocation slots");
+
+/**
+* Gets the CPU time used by the process
+* @return CPU time in seconds
+*/
+static double cpu_time()
+{
+#ifdef _WIN32
+	FILETIME creation, exit, kernel, user;
+
+	if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+		return 0;
+
+	ULARGE_INTEGER k, u;
+	k.LowPart = kernel.dwLowDateTime;
+	k.HighPart = kernel.dwHighDateTime;
+	u.LowPart = user.dwLowDateTime;
+	u.HighPart = user.dwHighDateTime;
+
+	return static_cast<double>(k.QuadPart + u.QuadPart) / 1e7; // 100ns units
+#else
+	timespec ts;
+
+	if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) != 0)
+		return 0;
+
+	return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+#endif
+}
+
+/**
+* Gets the peak resident memory of the process
+* @return Peak memory in bytes
+*/
+static uint64_t peak_rss()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS pmc;
+
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+		return 0;
+
+	return pmc.PeakWorkingSetSize;
+#else
+	rusage ru;
+
+	if (getrusage(RUSAGE_SELF, &ru) != 0)
+		return 0;
+
+#ifdef __APPLE__
+	return static_cast<uint64_t>(ru.ru_maxrss); // bytes
+#else
+	return static_cast<uint64_t>(ru.ru_maxrss) * 1024; // kilobytes
+#endif
+#endif
+}
+
+const char* Profiler::GetPhaseName(ProfilePhase phase)
+{
+	const auto i = static_cast<size_t>(phase);
+
+	if (i >= static_cast<size_t>(ProfilePhase::Count))
+		return "unknown";
+
+	return g_phase_names[i];
+}
+
+bool Profiler::EnableHardwareCounters()
+{
+	m_perf_enabled = true;
+	return m_perf.Open();
+}
+
+void Profiler::Begin(ProfilePhase phase)
+{
+	auto& p = m_phases[static_cast<size_t>(phase)];
+	p.cpu_start = cpu_time();
+	p.wall_start = std::chrono::steady_clock::now();
+
+	// read last so the setup above is not counted
+	if (m_perf.IsOpen())
+		m_perf.Read(p.perf_start);
+
+	if (m_tracer)
+		m_tracer->Begin(g_phase_names[static_cast<size_t>(phase)]);
+
+	if (AllocStats::IsEnabled())
+		AllocStats::SetSlot(static_cast<size_t>(phase));
+}
+
+void Profiler::End(ProfilePhase phase)
+{
+	auto& p = m_phases[static_cast<size_t>(phase)];
+
+	if (AllocStats::IsEnabled())
+		AllocStats::SetSlot(AllocStats::NoPhase);
+
+	if (m_perf.IsOpen())
+	{
+		PerfCounters::Values v;
+		m_perf.Read(v);
+
+		for (size_t i = 0; i < v.size(); i++)
+			p.perf[i] += v[i] - p.perf_start[i];
+	}
+
+	const auto now = std::chrono::steady_clock::now();
+
+	if (m_tracer)
+		m_tracer->End();
+
+	p.wall += std::chrono::duration<double>(now - p.wall_start).count();
+	p.cpu += cpu_time() - p.cpu_start;
+	p.count++;
+}
+
+void Profiler::ReadResourceUsage(CXTranslationUnit unit)
+{
+	m_memory.clear();
+
+	if (!unit)
+		return;
+
+	auto usage = clang_getCXTUResourceUsage(unit);
+
+	for (unsigned i = 0; i < usage.numEntries; i++)
+	{
+		MemoryEntry e;
+		e.name = clang_getTUResourceUsageName(usage.entries[i].kind);
+		e.bytes = usage.entries[i].amount;
+		m_memory.emplace_back(e);
+	}
+
+	clang_disposeCXTUResourceUsage(usage);
+}
+
+void Profiler::WriteText(std::ostream& os) const
+{
+	double wall = 0, cpu = 0;
+	const auto flags = os.flags();
+	const auto precision = os.precision();
+
+	os << "Time report:" << std::endl;
+	os << "  " << std::left << std::setw(10) << "phase" << std::right << std::setw(12) << "wall (ms)" << std::setw(12) << "cpu (ms)" << std::setw(8) << "runs" << std::endl;
+	os << std::fixed << std::setprecision(3);
+
+	for (size_t i = 0; i < m_phases.size(); i++)
+	{
+		const auto& p = m_phases[i];
+		wall += p.wall;
+		cpu += p.cpu;
+
+		os << "  " << std::left << std::setw(10) << g_phase_names[i] << std::right
+			<< std::setw(12) << p.wall * 1000.0 << std::setw(12) << p.cpu * 1000.0 << std::setw(8) << p.count << std::endl;
+	}
+
+	os << "  " << std::left << std::setw(10) << "total" << std::right
+		<< std::setw(12) << wall * 1000.0 << std::setw(12) << cpu * 1000.0 << std::endl;
+
+	if (!m_memory.empty())
+	{
+		os << "libclang memory:" << std::endl;
+
+		for (const auto& e : m_memory)
+			os << "  " << std::left << std::setw(56) << e.name << std::right << std::setw(12) << e.bytes << " bytes" << std::endl;
+	}
+
+	if (m_perf.IsOpen())
+	{
+		os << "Hardware counters:" << std::endl;
+		os << "  " << std::left << std::setw(10) << "phase" << std::right;
+
+		for (size_t i = 0; i < PerfCounters::Count; i++)
+			os << std::setw(16) << PerfCounters::GetName(i);
+
+		os << std::setw(8) << "ipc" << std::endl;
+
+		for (size_t i = 0; i < m_phases.size(); i++)
+		{
+			const auto& p = m_phases[i];
+
+			if (p.count == 0)
+				continue;
+
+			os << "  " << std::left << std::setw(10) << g_phase_names[i] << std::right;
+
+			for (size_t k = 0; k < PerfCounters::Count; k++)
+			{
+				if (m_perf.IsAvailable(k))
+					os << std::setw(16) << p.perf[k];
+				else
+					os << std::setw(16) << "n/a";
+			}
+
+			if (m_perf.IsAvailable(0) && m_perf.IsAvailable(1) && p.perf[0] != 0)
+				os << std::setw(8) << std::setprecision(2) << static_cast<double>(p.perf[1]) / static_cast<double>(p.perf[0]) << std::setprecision(3);
+
+			os << std::endl;
+		}
+	}
+	else if (m_perf_enabled)
+		os << "Hardware counters: unavailable (" << m_perf.GetError() << ")" << std::endl;
+
+	if (AllocStats::IsEnabled())
+	{
+		os << "Allocations:" << std::endl;
+		os << "  " << std::left << std::setw(10) << "phase" << std::right << std::setw(12) << "allocs" << std::setw(16) << "bytes" << std::setw(12) << "frees" << std::endl;
+
+		for (size_t i = 0; i <= m_phases.size(); i++)
+		{
+			const auto slot = i < m_phases.size() ? i : AllocStats::NoPhase;
+			const auto a = AllocStats::Get(slot);
+
+			os << "  " << std::left << std::setw(10) << (slot == AllocStats::NoPhase ? "other" : g_phase_names[i]) << std::right
+				<< std::setw(12) << a.allocs << std::setw(16) << a.bytes << std::setw(12) << a.frees << std::endl;
+		}
+	}
+
+	os << "Peak RSS: " << peak_rss() << " bytes" << std::endl;
+
+	os.flags(flags);
+	os.precision(precision);
+}
+
+void Profiler::WriteJson(std::ostream& os) const
+{
+	double wall = 0, cpu = 0;
+	const auto flags = os.flags();
+	const auto precision = os.precision();
+
+	os << std::fixed << std::setprecision(3);
+	os << "{\"phases\":[";
+
+	for (size_t i = 0; i < m_phases.size(); i++)
+	{
+		const auto& p = m_phases[i];
+		wall += p.wall;
+		cpu += p.cpu;
+
+		if (i > 0)
+			os << ",";
+
+		os << "{\"name\":\"" << g_phase_names[i] << "\",\"wall_ms\":" << p.wall * 1000.0
+			<< ",\"cpu_ms\":" << p.cpu * 1000.0 << ",\"runs\":" << p.count;
+
+		if (m_perf.IsOpen())
+		{
+			os << ",\"counters\":{";
+
+			for (size_t k = 0; k < PerfCounters::Count; k++)
+			{
+				os << (k > 0 ? "," : "") << "\"" << PerfCounters::GetName(k) << "\":";
+
+				if (m_perf.IsAvailable(k))
+					os << p.perf[k];
+				else
+					os << "null";
+			}
+
+			os << "}";
+		}
+
+		if (AllocStats::IsEnabled())
+		{
+			const auto a = AllocStats::Get(i);
+			os << ",\"allocs\":" << a.allocs << ",\"alloc_bytes\":" << a.bytes << ",\"frees\":" << a.frees;
+		}
+
+		os << "}";
+	}
+
+	os << "],\"total\":{\"wall_ms\":" << wall * 1000.0 << ",\"cpu_ms\":" << cpu * 1000.0 << "}";
+	os << ",\"libclang_memory\":{";
+
+	for (size_t i = 0; i < m_memory.size(); i++)
+	{
+		if (i > 0)
+			os << ",";
+
+		os << "\"" << m_memory[i].name << "\":" << m_memory[i].bytes;
+	}
+
+	os << "}";
+
+	if (m_perf_enabled)
+	{
+		os << ",\"hardware_counters\":" << (m_perf.IsOpen() ? "true" : "false");
+
+		if (!m_perf.IsOpen())
+			os << ",\"hardware_counters_error\":\"" << m_perf.GetError() << "\"";
+	}
+
+	if (AllocStats::IsEnabled())
+	{
+		const auto a = AllocStats::Get(AllocStats::NoPhase);
+		os << ",\"other_allocs\":{\"allocs\":" << a.allocs << ",\"alloc_bytes\":" << a.bytes << ",\"frees\":" << a.frees << "}";
+	}
+
+	os << ",\"peak_rss\":" << peak_rss() << "}" << std::endl;
+
+	os.flags(flags);
+	os.precision(precision);
+}
@@ -0,0 +1,196 @@
+/**
+* @file profiler.hpp
+* @author lakor64
+* @date 18/10/2026
+* @brief phase timing and memory report
+*/
+#pragma once
+
+#include "perfcounters.hpp"
+#include "tracer.hpp"
+
+#include <clang-c/Index.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+* Phases of the conversion
+*/
+enum class ProfilePhase
+{
+	/** libclang index creation */
+	Index,
+	/** clang_parseTranslationUnit2 */
+	Parse,
+	/** AST visit */
+	Visit,
+	/** evaluation of the preprocessor definitions */
+	Macro,
+	/** structure layouts and declaration order */
+	Fixup,
+	/** driver output */
+	Emit,
+	/** number of phases */
+	Count,
+};
+
+/**
+* Collects the wall and CPU time of each phase and the memory used by libclang,
+*  the hardware counters of each phase are also collected when they are enabled
+*/
+class Profiler final
+{
+public:
+	/**
+	* Default constructor
+	*/
+	explicit Profiler() : m_phases(), m_tracer(nullptr), m_perf_enabled(false) {}
+
+	/**
+	* Enables the hardware counters, if they cannot be opened the report
+	*  only notes that they are unavailable
+	* @return true if the counters are available
+	*/
+	bool EnableHardwareCounters();
+
+	/**
+	* Starts timing a phase
+	* @param phase Phase to start
+	*/
+	void Begin(ProfilePhase phase);
+
+	/**
+	* Stops timing a phase, the time is added to the previous runs of the phase
+	* @param phase Phase to stop
+	*/
+	void End(ProfilePhase phase);
+
+	/**
+	* Gets the total wall time of a phase
+	* @param phase Phase
+	* @return Wall time in seconds
+	*/
+	constexpr double GetWallTime(ProfilePhase phase) const { return m_phases[static_cast<size_t>(phase)].wall; }
+
+	/**
+	* Sets the tracer that records a span for every phase
+	* @param tracer Tracer to use or NULL to disable the tracing
+	*/
+	void SetTracer(Tracer* tracer) { m_tracer = tracer; }
+
+	/**
+	* Gets the tracer of the profiler
+	* @return Tracer or NULL if the tracing is disabled
+	*/
+	constexpr Tracer* GetTracer() const { return m_tracer; }
+
+	/**
+	* Reads the memory used by a translation unit
+	* @param unit Translation unit
+	*/
+	void ReadResourceUsage(CXTranslationUnit unit);
+
+	/**
+	* Writes a human readable report, the peak memory of the process is read at this point
+	* @param os Destination stream
+	*/
+	void WriteText(std::ostream& os) const;
+
+	/**
+	* Writes the report as JSON
+	* @param os Destination stream
+	*/
+	void WriteJson(std::ostream& os) const;
+
+	/**
+	* Gets the name of a phase
+	* @param phase Phase
+	* @return Name of the phase
+	*/
+	static const char* GetPhaseName(ProfilePhase phase);
+
+private:
+	/**
+	* Timing of a phase
+	*/
+	struct PhaseTime
+	{
+		/** wall time in seconds */
+		double wall = 0;
+		/** CPU time in seconds */
+		double cpu = 0;
+		/** number of times the phase was run */
+		uint32_t count = 0;
+		/** start of the current run */
+		std::chrono::steady_clock::time_point wall_start;
+		/** CPU time at the start of the current run */
+		double cpu_start = 0;
+		/** hardware counters */
+		PerfCounters::Values perf = {};
+		/** hardware counters at the start of the current run */
+		PerfCounters::Values perf_start = {};
+	};
+
+	/**
+	* Memory used by libclang
+	*/
+	struct MemoryEntry
+	{
+		/** name of the category */
+		std::string name;
+		/** bytes used */
+		unsigned long bytes;
+	};
+
+	/** time of each phase */
+	std::array<PhaseTime, static_cast<size_t>(ProfilePhase::Count)> m_phases;
+	/** libclang memory categories of the last translation unit */
+	std::vector<MemoryEntry> m_memory;
+	/** trace of the phases, can be NULL */
+	Tracer* m_tracer;
+	/** hardware counters */
+	PerfCounters m_perf;
+	/** if the hardware counters were requested */
+	bool m_perf_enabled;
+};
+
+/**
+* Times a phase until the end of the scope, the profiler can be NULL
+*/
+class ProfileScope final
+{
+public:
+	/**
+	* Default constructor
+	* @param profiler Profiler to use
+	* @param phase Phase to time
+	*/
+	explicit ProfileScope(Profiler* profiler, ProfilePhase phase) : m_profiler(profiler), m_phase(phase)
+	{
+		if (m_profiler)
+			m_profiler->Begin(m_phase);
+	}
+
+	/**
+	* Default deconstructor
+	*/
+	~ProfileScope()
+	{
+		if (m_profiler)
+			m_profiler->End(m_phase);
+	}
+
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+	/** profiler */
+	Profiler* m_profiler;
+	/** timed phase */
+	ProfilePhase m_phase;
+};
@@ -0,0 +1,123 @@
+/**
+* @file stats.cpp
+* @author lakor64
+* @date 18/10/2026
+* @brief internal statistics counters
+*/
+#include "stats.hpp"
+#include "clangutils.hpp"
+
+#include <iomanip>
+#include <string>
+
+/**
+* Names of the counters
+*/
+static constexpr const char* g_counter_names[] = {
+	"cursors_skipped",
+	"members_created",
+	"members_duplicated",
+	"findtype_hits",
+	"findtype_misses",
+	"macros_tokenized",
+	"macros_evaluated",
+	"fixup_passes",
+	"driver_typedef",
+	"driver_union",
+	"driver_struct",
+	"driver_enum",
+	"driver_define",
+	"driver_globalvar",
+	"driver_function",
+	"bytes_written",
+};
+
+static_assert(sizeof(g_counter_names) / sizeof(g_counter_names[0]) == static_cast<size_t>(StatCounter::Count), "missing counter name");
+
+Stats::Stats()
+{
+	for (auto& c : m_counters)
+		c.store(0, std::memory_order_relaxed);
+
+	for (auto& c : m_cursors)
+		c.store(0, std::memory_order_relaxed);
+}
+
+Stats& Stats::Get()
+{
+	static Stats stats;
+	return stats;
+}
+
+const char* Stats::GetCounterName(StatCounter c)
+{
+	const auto i = static_cast<size_t>(c);
+
+	if (i >= static_cast<size_t>(StatCounter::Count))
+		return "unknown";
+
+	return g_counter_names[i];
+}
+
+void Stats::AddCursor(CXCursorKind kind)
+{
+	const auto i = static_cast<size_t>(kind);
+
+	if (i < MaxCursorKind)
+		m_cursors[i].fetch_add(1, std::memory_order_relaxed);
+}
+
+void Stats::WriteText(std::ostream& os) const
+{
+	const auto flags = os.flags();
+
+	os << "Statistics:" << std::endl;
+
+	for (size_t i = 0; i < m_counters.size(); i++)
+		os << "  " << std::left << std::setw(32) << g_counter_names[i] << std::right << std::setw(12) << m_counters[i].load(std::memory_order_relaxed) << std::endl;
+
+	os << "Visited cursors:" << std::endl;
+
+	for (size_t i = 0; i < m_cursors.size(); i++)
+	{
+		const auto n = m_cursors[i].load(std::memory_order_relaxed);
+
+		if (n == 0)
+			continue;
+
+		ClangStr name(clang_getCursorKindSpelling(static_cast<CXCursorKind>(i)));
+		os << "  " << std::left << std::setw(32) << name.Get() << std::right << std::setw(12) << n << std::endl;
+	}
+
+	os.flags(flags);
+}
+
+void Stats::WriteJson(std::ostream& os) const
+{
+	os << "{\"counters\":{";
+
+	for (size_t i = 0; i < m_counters.size(); i++)
+	{
+		if (i > 0)
+			os << ",";
+
+		os << "\"" << g_counter_names[i] << "\":" << m_counters[i].load(std::memory_order_relaxed);
+	}
+
+	os << "},\"cursors\":{";
+
+	bool first = true;
+	for (size_t i = 0; i < m_cursors.size(); i++)
+	{
+		const auto n = m_cursors[i].load(std::memory_order_relaxed);
+
+		if (n == 0)
+			continue;
+
+		ClangStr name(clang_getCursorKindSpelling(static_cast<CXCursorKind>(i)));
+		os << (first ? "" : ",") << "\"" << name.Get() << "\":" << n;
+		first = false;
+	}
+
+	os << "}}" << std::endl;
+}
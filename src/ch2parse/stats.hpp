@@ -0,0 +1,128 @@
+/**
+* @file stats.hpp
+* @author lakor64
+* @date 18/10/2026
+* @brief internal statistics counters
+*/
+#pragma once
+
+#include <clang-c/Index.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+
+/**
+* Internal counters
+*/
+enum class StatCounter
+{
+	/** cursors that were not converted */
+	CursorsSkipped,
+	/** members created by the visitor */
+	MembersCreated,
+	/** members discarded because they already exist */
+	MembersDuplicated,
+	/** type lookups that found a type */
+	FindTypeHits,
+	/** type lookups that did not find a type */
+	FindTypeMisses,
+	/** preprocessor definitions tokenized */
+	MacrosTokenized,
+	/** preprocessor definitions evaluated as expressions */
+	MacrosEvaluated,
+	/** sorting passes of FixupDecls */
+	FixupPasses,
+	/** Driver::WriteTypeDef calls */
+	DriverTypedef,
+	/** Driver::WriteUnion calls */
+	DriverUnion,
+	/** Driver::WriteStruct calls */
+	DriverStruct,
+	/** Driver::WriteEnum calls */
+	DriverEnum,
+	/** Driver::WriteDefine calls */
+	DriverDefine,
+	/** Driver::WriteGlobalVar calls */
+	DriverGlobalVar,
+	/** Driver::WriteFunction calls */
+	DriverFunction,
+	/** bytes of the output file */
+	BytesWritten,
+	/** number of counters */
+	Count,
+};
+
+/**
+* Process-wide statistics, the counters are only updated when
+*  the application is built with CH2_ENABLE_STATS
+*/
+class Stats final
+{
+public:
+	/**
+	* Gets the statistics of the process
+	* @return Statistics
+	*/
+	static Stats& Get();
+
+	/**
+	* Increments a counter
+	* @param c Counter to increment
+	* @param n Value to add
+	*/
+	void Add(StatCounter c, uint64_t n = 1) { m_counters[static_cast<size_t>(c)].fetch_add(n, std::memory_order_relaxed); }
+
+	/**
+	* Increments the counter of a cursor kind
+	* @param kind Visited cursor kind
+	*/
+	void AddCursor(CXCursorKind kind);
+
+	/**
+	* Writes the counters as a table
+	* @param os Destination stream
+	*/
+	void WriteText(std::ostream& os) const;
+
+	/**
+	* Writes the counters as JSON
+	* @param os Destination stream
+	*/
+	void WriteJson(std::ostream& os) const;
+
+	/**
+	* Gets the name of a counter
+	* @param c Counter
+	* @return Name of the counter
+	*/
+	static const char* GetCounterName(StatCounter c);
+
+private:
+	/**
+	* Default constructor
+	*/
+	explicit Stats();
+
+	/** highest cursor kind that is counted */
+	static constexpr size_t MaxCursorKind = 1024;
+
+	/** counters */
+	std::array<std::atomic<uint64_t>, static_cast<size_t>(StatCounter::Count)> m_counters;
+	/** visited cursors per kind */
+	std::array<std::atomic<uint64_t>, MaxCursorKind> m_cursors;
+};
+
+#ifdef CH2_ENABLE_STATS
+/** increments a statistics counter */
+#define CH2_STAT(c) Stats::Get().Add(StatCounter::c)
+/** adds a value to a statistics counter */
+#define CH2_STAT_ADD(c, n) Stats::Get().Add(StatCounter::c, (n))
+/** increments the counter of a cursor kind */
+#define CH2_STAT_CURSOR(k) Stats::Get().AddCursor(k)
+#else
+#define CH2_STAT(c) ((void)0)
+#define CH2_STAT_ADD(c, n) ((void)0)
+#define CH2_STAT_CURSOR(k) ((void)0)
+#endif
@@ -0,0 +1,143 @@
+/**
+* @file tokencache.cpp
+* @author lakor64
+* @date 18/10/2026
+* @brief shared token buffer of the parsed files
+*/
+#include "tokencache.hpp"
+#include "clangutils.hpp"
+
+#include <algorithm>
+
+void TokenCache::Reset(CXTranslationUnit unit)
+{
+	m_unit = unit;
+	m_files.clear();
+	m_ranges.clear();
+	m_spellings.clear();
+	m_last = nullptr;
+	m_last_tokens = nullptr;
+}
+
+void TokenCache::Tokenize(CXFile file, FileTokens& ft)
+{
+	size_t size = 0;
+	const char* buffer = clang_getFileContents(m_unit, file, &size);
+
+	if (!buffer)
+		return;
+
+	const auto range = clang_getRange(clang_getLocationForOffset(m_unit, file, 0),
+		clang_getLocationForOffset(m_unit, file, static_cast<unsigned>(size)));
+
+	unsigned int numTokens = 0;
+	CXToken* tokens = nullptr;
+	clang_tokenize(m_unit, range, &tokens, &numTokens);
+
+	ft.tokens.reserve(numTokens);
+
+	for (auto i = 0U; i < numTokens; i++)
+	{
+		const auto extent = clang_getTokenExtent(m_unit, tokens[i]);
+		unsigned start = 0, end = 0;
+
+		clang_getSpellingLocation(clang_getRangeStart(extent), nullptr, nullptr, nullptr, &start);
+		clang_getSpellingLocation(clang_getRangeEnd(extent), nullptr, nullptr, nullptr, &end);
+
+		CachedToken t;
+		t.kind = clang_getTokenKind(tokens[i]);
+		t.offset = start;
+		t.spelling = std::string_view(buffer + start, end - start);
+		ft.tokens.emplace_back(t);
+	}
+
+	// we only keep the spelling views, the clang tokens are not needed anymore
+	clang_disposeTokens(m_unit, tokens, numTokens);
+}
+
+TokenSlice TokenCache::Get(CXSourceRange range)
+{
+	CXFile file = nullptr;
+	unsigned start = 0, end = 0;
+
+	clang_getSpellingLocation(clang_getRangeStart(range), &file, nullptr, nullptr, &start);
+	clang_getSpellingLocation(clang_getRangeEnd(range), nullptr, nullptr, nullptr, &end);
+
+	// the predefined macros (eg: __GCC_HAVE_DWARF2_CFI_ASM) are not inside a file
+	if (!file)
+		return TokenizeRange(range);
+
+	const auto& tokens = Find(file).tokens;
+	const auto cmp = [](const CachedToken& t, unsigned offset) { return t.offset < offset; };
+
+	// the range end points after the last token of the range
+	const auto first = std::lower_bound(tokens.begin(), tokens.end(), start, cmp);
+	const auto last = std::lower_bound(first, tokens.end(), end, cmp);
+
+	return TokenSlice(tokens.data() + (first - tokens.begin()), tokens.data() + (last - tokens.begin()));
+}
+
+TokenSlice TokenCache::TokenizeRange(CXSourceRange range)
+{
+	unsigned int numTokens = 0;
+	CXToken* tokens = nullptr;
+	clang_tokenize(m_unit, range, &tokens, &numTokens);
+
+	if (numTokens == 0)
+		return TokenSlice();
+
+	// there is no file buffer, the spellings are copied
+	auto& ft = m_ranges.emplace_back();
+	ft.tokens.reserve(numTokens);
+
+	for (auto i = 0U; i < numTokens; i++)
+	{
+		ClangStr spelling(clang_getTokenSpelling(m_unit, tokens[i]));
+		const auto& str = m_spellings.emplace_back(spelling.Get());
+
+		CachedToken t;
+		t.kind = clang_getTokenKind(tokens[i]);
+		t.offset = i;
+		t.spelling = str;
+		ft.tokens.emplace_back(t);
+	}
+
+	clang_disposeTokens(m_unit, tokens, numTokens);
+	return TokenSlice(ft.tokens.data(), ft.tokens.data() + ft.tokens.size());
+}
+
+TokenSlice TokenCache::GetFile(CXFile file)
+{
+	if (!file)
+		return TokenSlice();
+
+	const auto& tokens = Find(file).tokens;
+	return TokenSlice(tokens.data(), tokens.data() + tokens.size());
+}
+
+const TokenCache::FileTokens& TokenCache::Find(CXFile file)
+{
+	if (file != m_last)
+	{
+		auto it = m_files.find(file);
+
+		if (it == m_files.end())
+		{
+			if (m_tracer)
+			{
+				ClangStr name(clang_getFileName(file));
+				m_tracer->Instant("token cache miss", name.Get());
+			}
+
+			it = m_files.emplace(file, FileTokens()).first;
+			Tokenize(file, it->second);
+		}
+		else if (m_tracer)
+			m_tracer->Instant("token cache hit");
+
+		m_last = file;
+		m_last_tokens = &it->second;
+	}
+
+	return *m_last_tokens;
+}
@@ -0,0 +1,164 @@
+/**
+* @file tokencache.hpp
+* @author lakor64
+* @date 18/10/2026
+* @brief shared token buffer of the parsed files
+*/
+#pragma once
+
+#include "tracer.hpp"
+
+#include <clang-c/Index.h>
+
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+* A single token of a tokenized file
+*/
+struct CachedToken
+{
+	/** kind of the token */
+	CXTokenKind kind;
+	/** offset of the token inside the file */
+	unsigned offset;
+	/** spelling of the token, this is a view inside the clang file buffer */
+	std::string_view spelling;
+};
+
+/**
+* A slice of the tokens of a file
+*/
+class TokenSlice final
+{
+public:
+	/**
+	* Default constructor
+	* @param first First token of the slice
+	* @param last End of the slice
+	*/
+	explicit TokenSlice(const CachedToken* first = nullptr, const CachedToken* last = nullptr) : m_first(first), m_last(last) {}
+
+	/**
+	* Gets the number of tokens in the slice
+	* @return Number of tokens
+	*/
+	constexpr size_t size() const { return m_last - m_first; }
+
+	/**
+	* Checks if the slice does not have any token
+	* @return true if the slice is empty, otherwise false
+	*/
+	constexpr bool empty() const { return m_first == m_last; }
+
+	/**
+	* Gets the first token of the slice
+	*/
+	constexpr const CachedToken* begin() const { return m_first; }
+
+	/**
+	* Gets the end of the slice
+	*/
+	constexpr const CachedToken* end() const { return m_last; }
+
+	/**
+	* Gets a token of the slice
+	* @param i Index of the token
+	*/
+	constexpr const CachedToken& operator[](size_t i) const { return m_first[i]; }
+
+private:
+	/** first token */
+	const CachedToken* m_first;
+	/** end of the tokens */
+	const CachedToken* m_last;
+};
+
+/**
+* Tokenizes each file of a translation unit only once and gives
+* slices of it to the caller
+* @note The spellings are valid until the translation unit is disposed
+*/
+class TokenCache final
+{
+public:
+	/**
+	* Default constructor
+	*/
+	explicit TokenCache() : m_unit(nullptr), m_last(nullptr), m_last_tokens(nullptr), m_tracer(nullptr) {}
+
+	/**
+	* Resets the cache to a new translation unit
+	* @param unit Translation unit to cache
+	*/
+	void Reset(CXTranslationUnit unit);
+
+	/**
+	* Sets the tracer that records the cache hits and misses
+	* @param tracer Tracer to use or NULL
+	*/
+	void SetTracer(Tracer* tracer) { m_tracer = tracer; }
+
+	/**
+	* Gets the tokens inside the specified range
+	* @param range Source range (eg: a cursor extent)
+	* @return Slice of the tokens inside the range
+	*/
+	TokenSlice Get(CXSourceRange range);
+
+	/**
+	* Gets all the tokens of a file
+	* @param file File of the translation unit
+	* @return Slice of the tokens of the file
+	*/
+	TokenSlice GetFile(CXFile file);
+
+private:
+	/**
+	* Tokens of a single file
+	*/
+	struct FileTokens
+	{
+		/** all the tokens of the file ordered by offset */
+		std::vector<CachedToken> tokens;
+	};
+
+	/**
+	* Tokenizes an entire file
+	* @param file File to tokenize
+	* @param ft Destination tokens
+	*/
+	void Tokenize(CXFile file, FileTokens& ft);
+
+	/**
+	* Tokenizes a range that is not inside a file (predefined macros)
+	* @param range Source range
+	* @return Slice of the tokens of the range
+	*/
+	TokenSlice TokenizeRange(CXSourceRange range);
+
+	/**
+	* Gets the tokens of a file, tokenizing it if it was not used before
+	* @param file File to get
+	* @return Tokens of the file
+	*/
+	const FileTokens& Find(CXFile file);
+
+	/** translation unit */
+	CXTranslationUnit m_unit;
+	/** tokens of each file */
+	std::unordered_map<CXFile, FileTokens> m_files;
+	/** tokens of the ranges outside of the files */
+	std::deque<FileTokens> m_ranges;
+	/** spellings of the tokens outside of the files */
+	std::deque<std::string> m_spellings;
+	/** last file used */
+	CXFile m_last;
+	/** tokens of the last file used */
+	FileTokens* m_last_tokens;
+	/** records the cache hits and misses, can be NULL */
+	Tracer* m_tracer;
+};
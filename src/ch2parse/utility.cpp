@@ -6,63 +6,6 @@
 */
 #include "utility.hpp"
 
-PrimitiveType Utility::GetPrimitiveTypeForPlatform(const std::string& name, const PlatformInfo& platform)
-{
-	if (name == "char")
-		return PrimitiveType::Byte;
-	else if (name == "short")
-		return PrimitiveType::Word;
-	else if (name == "int")
-	{
-		if (platform.GetBits() == 16)
-			return PrimitiveType::Word;
-
-		return PrimitiveType::DWord;
-	}
-	else if (name == "long")
-	{
-		if ((platform.GetType() == PlatformType::Linux || platform.GetType() == PlatformType::Darwin) && platform.GetBits() == 64)
-			return PrimitiveType::QWord;
-
-		return PrimitiveType::DWord;
-	}
-	else if (name == "long long")
-		return PrimitiveType::QWord;
-	else if (name == "float")
-		return PrimitiveType::Real4;
-	else if (name == "double")
-		return PrimitiveType::Real8;
-	else if (name == "long double")
-	{
-		return platform.HaveReal10() ? PrimitiveType::Real10 : PrimitiveType::Real8;
-	}
-	else if (name == "wchar_t")
-	{
-		if (platform.GetType() == PlatformType::Linux || platform.GetType() == PlatformType::Darwin)
-			return PrimitiveType::DWord;
-
-		return PrimitiveType::Word;
-	}
-	else if (name == "__int128")
-		return PrimitiveType::OWord;
-	else if (name == "*")
-	{
-		switch (platform.GetBits())
-		{
-		case 16:
-			return PrimitiveType::Word;
-		case 32:
-			return PrimitiveType::DWord;
-		case 64:
-			return PrimitiveType::QWord;
-		default:
-			break;
-		}
-	}
-
-	return PrimitiveType::Invalid;
-}
-
 CH2ErrorCodes Utility::CXErrorToCH2Error(CXErrorCode ec)
 {
 	switch (ec)
@@ -124,24 +67,3 @@ StorageType Utility::CXStorageTypeToCH2StorageType(CX_StorageClass c)
 
 	return StorageType::None;
 }
-
-std::string Utility::GetPrimitiveNameFromSize(int size)
-{
-	switch (size)
-	{
-	case 8:
-		return "char";
-	case 16:
-		return "short";
-	case 32:
-		return "int";
-	case 64:
-		return "long long";
-	case 80:
-		return "long double";
-	default:
-		break;
-	}
-
-	return "";
-}
\ No newline at end of file
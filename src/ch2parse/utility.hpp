@@ -17,14 +17,6 @@
 
 namespace Utility
 {
-	/**
-	* Gets the primitive type for the specified platform
-	* @param name Name of the type
-	* @param platform Platform configuration
-	* @return fetched primitive type
-	*/
-	PrimitiveType GetPrimitiveTypeForPlatform(const std::string& name, const PlatformInfo& platform);
-
 	/**
 	* Translates a libclang error into the library errors
 	* @param ec Error to translate
@@ -45,11 +37,4 @@ namespace Utility
 	* @return library storage type
 	*/
 	StorageType CXStorageTypeToCH2StorageType(CX_StorageClass c);
-
-	/**
-	* Gets the name of the primitive from the size
-	* @param size Primitive size
-	* @return Primitive name
-	*/
-	std::string GetPrimitiveNameFromSize(int size);
 }
@@ -7,10 +7,34 @@
 #include "masmdriver.hpp"
 
 /**
-* Entrypoint of the driver
+* Creates the driver
 * @return Implementation of a ch2inc driver
 */
-extern "C" Driver* CH2DriverEntrypoint(void)
+static Driver* create_driver(void)
 {
 	return new MasmDriver();
 }
+
+const DriverDescriptor MasmDriver::Descriptor = {
+	DRIVER_ABI_VERSION,
+	"MASM CH2 Driver",
+	__TIMESTAMP__,
+	"lakor64",
+	DRIVER_CAP_PARALLEL_WRITE | DRIVER_CAP_WRITE_FILE | DRIVER_CAP_LAYOUT,
+	0, // MASM is x86 only, every platform is x86
+	DRIVER_BITS_16 | DRIVER_BITS_32 | DRIVER_BITS_64,
+	create_driver,
+};
+
+/**
+* Descriptor of the driver, a built-in driver has an unique name in the registry
+* @return Descriptor of the driver
+*/
+#ifdef CH2_BUILTIN_DRIVER
+extern "C" const DriverDescriptor* DRIVER_BUILTIN_DESCRIPTOR(CH2_BUILTIN_DRIVER)(void)
+#else
+extern "C" const DriverDescriptor* CH2DriverDescriptor(void)
+#endif
+{
+	return &MasmDriver::Descriptor;
+}
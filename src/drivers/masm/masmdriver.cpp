@@ -7,7 +7,10 @@
 #include "masmdriver.hpp"
 #include "strconv.h"
 #include <writerhelp.hpp>
-#include <stack>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
 
 // TODO: Refactor this crappy code to properly use Variable
 
@@ -30,16 +33,9 @@ void MasmDriver::CopyName(std::string& dst, const LinkType& link)
 		link.ref_type->GetTypeID() == MemberType::Struct
 		)
 	{
-		const std::string n = link.ref_type->GetName();
-		for (size_t k = 0; k < m_tag_link.size(); k++)
-		{
-			if (m_tag_link[k] == n)
-			{
-				dst += "@tag_" + std::to_string(k);
-				return;
-			}
-		}
-		dst += n;
+		// unnamed structures are referenced by their tag
+		const auto& tag = FindName(m_symbols->tag_names, link.ref_type);
+		dst += tag.empty() ? link.ref_type->GetName() : tag;
 	}
 	else
 	{
@@ -55,8 +51,7 @@ void MasmDriver::WriteVariable(const Variable& v)
 
 	if (v.GetRef().pointers)
 	{
-		typeName = "@t_" + std::to_string(m_total_used_typedef);
-		m_total_used_typedef++;
+		typeName = FindName(m_symbols->typedef_names, &v);
 	}
 	else
 	{
@@ -68,7 +63,7 @@ void MasmDriver::WriteVariable(const Variable& v)
 		}
 	}
 
-	writefmt(m_cfg.fp, "{}\t\t{}\t\t", v.GetName(), typeName);
+	writefmt(*m_cfg.out, "{}\t\t{}\t\t", v.GetName(), typeName);
 
 	const auto& az = v.GetArraySizes();
 
@@ -76,20 +71,20 @@ void MasmDriver::WriteVariable(const Variable& v)
 	{
 		for (const auto& dups : az)
 		{
-			writefmt(m_cfg.fp, " {}t DUP (", dups);
+			writefmt(*m_cfg.out, " {}t DUP (", dups);
 		}
 
-		writefmt(m_cfg.fp, "?");
+		writefmt(*m_cfg.out, "?");
 
 		for (const auto& dups : az)
 		{
-			writefmt(m_cfg.fp, ")");
+			writefmt(*m_cfg.out, ")");
 		}
-		writefmt(m_cfg.fp, "\n");
+		writefmt(*m_cfg.out, "\n");
 	}
 	else
 	{
-		writefmt(m_cfg.fp, " {}\n", usetags ? "<>" : "?");
+		writefmt(*m_cfg.out, " {}\n", usetags ? "<>" : "?");
 	}
 }
 
@@ -97,87 +92,100 @@ void MasmDriver::WriteStructMembers(const Struct& stru)
 {
 	int64_t totalprct = 0;
 	const auto& fields = stru.GetFields();
+	const std::string_view structname = stru.GetName();
 
-	for (size_t i = 0; i < fields.size(); i++)
+	for (const auto& entry : stru.GetLayout())
 	{
-		const auto& field = fields[i];
-
-		if (field->GetSize() == -1) // bitsize > 0 works differently
+		switch (entry.type)
 		{
-			WriteVariable(*field);
-		}
-		else
+		case LayoutEntryType::Field:
+			WriteVariable(*fields[entry.first]);
+			break;
+
+		case LayoutEntryType::BitGroup:
 		{
 			/*
 				MASM writes thing in BE, our CPU is in LE so what we need to do is:
-				- iterate trough all types which bitSize != -1
-				- store all the types in a FIFO queue so we top last -> first
-				- check if the processed total data of our bitwise matches the base type requested
+				- check if the bits used by the group matches the size of the storage unit
 				  if not, then we need to add padding
-				- iterare trough all of our stack and write data from last to begin
+				- write the fields of the group from last to begin
 			*/
+			const auto& last = fields[entry.first + entry.count - 1];
+			int64_t processed = 0;
 
-			const std::string_view structname = stru.GetName();
-			std::stack<StructField*> m_bitstack;
-			auto prim = dynamic_cast<const Primitive*>(field->GetRef().ref_type)->GetType();
-			int64_t processed = field->GetSize();
-			size_t k;
-			m_bitstack.push(field);
-
-			for (k = i + 1; k < fields.size(); k++)
+			if (entry.offset >= 0)
+				processed = last->GetOffset() + last->GetSize() - entry.offset;
+			else
 			{
-				auto field2 = fields[k];
-				auto prim2 = dynamic_cast<const Primitive*>(field2->GetRef().ref_type);
-				if (!prim2 || prim2->GetTypeID() != MemberType::Primitive)
-					break;
+				for (uint32_t k = 0; k < entry.count; k++)
+					processed += fields[entry.first + k]->GetSize();
+			}
+
+			// MASM stores a RECORD in a BYTE, WORD, DWORD or QWORD (ml64 only), a group of packed bitfields
+			//  can have another size and then its storage is written as bytes
+			const auto maxbits = m_cfg.platform.GetBits() == 64 ? 64 : 32;
+			const auto regular = entry.size <= maxbits && (entry.size & (entry.size - 1)) == 0 && entry.size >= 8;
 
-				if (prim2->GetType() != prim || field2->GetSize() == -1)
-					break;
+			if (entry.size > maxbits)
+			{
+				// ; a:20 q:10 l:6 (no RECORD)
+				writefmt(*m_cfg.out, ";");
 
-				if (processed + field2->GetSize() > PrimitiveGetBitSize(prim))
-					break;
+				for (uint32_t k = 0; k < entry.count; k++)
+				{
+					const auto& field = fields[entry.first + k];
+					writefmt(*m_cfg.out, " {}:{}", field->GetName(), field->GetSize());
+				}
 
-				m_bitstack.push(fields[k]);
-				processed += fields[k]->GetSize();
-				i++;
+				// @bit_0  BYTE 6t DUP (?)
+				writefmt(*m_cfg.out, " (too large for a RECORD)\n"
+								"@bit_{}\t\tBYTE {}t DUP (?)\n", totalprct, entry.size / 8);
 
-				if (processed == PrimitiveGetBitSize(prim))
-					break;
+				totalprct++;
+				break;
 			}
 
 			// rec@x_0   RECORD
-			writefmt(m_cfg.fp, "rec@{}_{}\t\tRECORD\t", structname, totalprct);
+			writefmt(*m_cfg.out, "rec@{}_{}\t\tRECORD\t", structname, totalprct);
 
 			bool writeretn = false;
 
-			if (processed != PrimitiveGetBitSize(prim))
+			if (processed < entry.size)
 			{
 				// this adds the missing padding
 
 				// @0@x:5
-				writefmt(m_cfg.fp, "@0@{}:{}", structname, PrimitiveGetBitSize(prim) - processed);
+				writefmt(*m_cfg.out, "@0@{}:{}", structname, entry.size - processed);
 				writeretn = true;
 			}
 
-			while (!m_bitstack.empty())
+			for (auto k = entry.count; k-- > 0; )
 			{
 				if (!writeretn)
 					writeretn = true;
 				else
-					writefmt(m_cfg.fp, ",\n\t\t\t\t");
+					writefmt(*m_cfg.out, ",\n\t\t\t\t");
 
-					// p@x:3
-				const auto top = m_bitstack.top();
-				writefmt(m_cfg.fp, "{}@{}:{}", top->GetName(), structname, top->GetSize());
-
-				m_bitstack.pop();
+				// p@x:3
+				const auto& field = fields[entry.first + k];
+				writefmt(*m_cfg.out, "{}@{}:{}", field->GetName(), structname, field->GetSize());
 			}
 
 			// @bit_0  rec@x_0 <>
-			writefmt(m_cfg.fp, "\n"
-							"@bit_{}\t\trec@{}_{} <>\n", totalprct, structname, totalprct);
+			if (regular)
+				writefmt(*m_cfg.out, "\n"
+								"@bit_{}\t\trec@{}_{} <>\n", totalprct, structname, totalprct);
+			else
+				writefmt(*m_cfg.out, "\n"
+								"@bit_{}\t\tBYTE {}t DUP (?)\n", totalprct, entry.size / 8);
 
 			totalprct++;
+			break;
+		}
+
+		case LayoutEntryType::Padding:
+			// MASM aligns the fields by itself using the alignment of the STRUCT
+			break;
 		}
 	}
 }
@@ -190,36 +198,124 @@ void MasmDriver::PreprocessVariable(const Variable& v)
 
 	if (fnclink) // typeid == Function
 	{
-		WriteFunctionTypedef(*fnclink);
+		WriteFunctionTypedef(*fnclink, v);
 	}
 
-	if (link.pointers)
+	// only the first variable of a pointer type declares the typedef
+	const auto decl = m_symbols->typedef_decls.find(&v);
+
+	if (decl != m_symbols->typedef_decls.end())
+		writefmt(*m_cfg.out, "{}\t\tTYPEDEF\t\t{}\n", FindName(m_symbols->typedef_names, &v), decl->second);
+}
+
+void MasmDriver::AssignVariableNames(const Variable& v)
+{
+	const auto& link = v.GetRef();
+
+	// the prototype of the function is written before the variable
+	if (link.ref_type && link.ref_type->GetTypeID() == MemberType::Function)
+		AssignProto(v, *static_cast<const Function*>(link.ref_type));
+
+	if (!link.pointers)
+		return;
+
+	std::string fullname = "";
+
+	for (long long i = 0; i < link.pointers; i++)
+	{
+		fullname += "PTR ";
+	}
+
+	if (link.ref_type->GetName() != "*")
+	{
+		if (link.ref_type->GetTypeID() == MemberType::Primitive)
+			fullname += get_primitive_name(*dynamic_cast<Primitive*>(link.ref_type));
+		else if (link.ref_type->GetTypeID() == MemberType::Function)
+			fullname += FindName(m_symbols->proto_names, &v);
+		else
+			fullname += link.ref_type->GetName();
+	}
+
+	// variables with the same pointer type share the typedef
+	auto it = m_symbols->ptr_typedefs.find(fullname);
+
+	if (it == m_symbols->ptr_typedefs.end())
+	{
+		it = m_symbols->ptr_typedefs.emplace(fullname, "@t_" + std::to_string(m_symbols->total_typedefs++)).first;
+		m_symbols->typedef_decls.emplace(&v, fullname);
+	}
+
+	m_symbols->typedef_names.emplace(&v, it->second);
+}
+
+void MasmDriver::AssignNames(const BasicMember& type)
+{
+	// the workers of the parallel write only read the table
+	if (m_symbols->named.find(&type) != m_symbols->named.end())
+		return;
+
+	m_symbols->named.insert(&type);
+
+	switch (type.GetTypeID())
+	{
+	case MemberType::Struct:
+	case MemberType::Union:
 	{
-		std::string fullname = "";
+		const auto& stru = static_cast<const Struct&>(type);
 
-		for (long long i = 0; i < link.pointers; i++)
+		for (const auto& field : stru.GetFields())
+			AssignVariableNames(*field);
+
+		if (stru.IsUnnamed())
+			m_symbols->tag_names.emplace(&type, "@tag_" + std::to_string(m_symbols->total_tags++));
+
+		break;
+	}
+	case MemberType::Function:
+		AssignProto(type, static_cast<const Function&>(type));
+		break;
+	case MemberType::GlobalVar:
+	{
+		const auto& var = static_cast<const GlobalVar&>(type);
+
+		if (var.GetStorageType() == StorageType::Static)
 		{
-			fullname += "PTR ";
+			// the first static variable writes .DATA
+			if (!m_symbols->data_owner)
+				m_symbols->data_owner = &type;
+
+			AssignVariableNames(var);
 		}
 
-		if (link.ref_type->GetName() != "*")
+		break;
+	}
+	case MemberType::Define:
+		switch (static_cast<const Define&>(type).GetDefineType())
 		{
-			if (link.ref_type->GetTypeID() == MemberType::Primitive)
-				fullname += get_primitive_name(*dynamic_cast<Primitive*>(link.ref_type));
-			else if (fnclink)
-			{
-				fullname += "@proto_" + std::to_string(m_total_protos);
-				m_total_protos++;
-			}
-			else
-				fullname += link.ref_type->GetName();
+		case DefineType::None:
+		case DefineType::Float:
+		case DefineType::Binary:
+			// not written
+			break;
+		default:
+			m_symbols->define_order.emplace(&type, m_symbols->total_defines++);
+			break;
 		}
 
-		writefmt(m_cfg.fp, "@t_{}\t\tTYPEDEF\t\t{}\n", m_total_preprocess_typedef, fullname);
-		m_total_preprocess_typedef++;
+		break;
+	default:
+		break;
 	}
 }
 
+const std::string& MasmDriver::FindName(const std::unordered_map<const BasicMember*, std::string>& names, const BasicMember* type)
+{
+	static const std::string empty;
+
+	const auto it = names.find(type);
+	return it != names.end() ? it->second : empty;
+}
+
 void MasmDriver::PreprocessStruct(const Struct& stru)
 {
 	for (const auto& field : stru.GetFields())
@@ -230,7 +326,7 @@ void MasmDriver::PreprocessStruct(const Struct& stru)
 
 void MasmDriver::WriteFileStart(void)
 {
-	writefmt(m_cfg.fp,
+	writefmt(*m_cfg.out,
 		"\n"
 		"option expr32\n"
 		"option casemap:none\n"
@@ -241,22 +337,23 @@ void MasmDriver::WriteFileStart(void)
 
 void MasmDriver::WriteFileEnd(void)
 {
-	writefmt(m_cfg.fp, "; End of the file\n");
+	writefmt(*m_cfg.out, "; End of the file\n");
+	m_cfg.out->Flush();
 }
 
 void MasmDriver::WriteSingleComment(const std::string& comment)
 {
-	writefmt(m_cfg.fp, "; {}\n", comment);
+	writefmt(*m_cfg.out, "; {}\n", comment);
 }
 
 void MasmDriver::WriteMultiComment(const std::vector<std::string>& v)
 {
-	writefmt(m_cfg.fp, "COMMENT @$?\n\n");
+	writefmt(*m_cfg.out, "COMMENT @$?\n\n");
 	for (const auto& comment : v)
 	{
-		writefmt(m_cfg.fp, comment);
+		writefmt(*m_cfg.out, comment);
 	}
-	writefmt(m_cfg.fp, "\n@$?\n");
+	writefmt(*m_cfg.out, "\n@$?\n");
 }
 
 void MasmDriver::WriteTypeDef(const Typedef& type)
@@ -264,50 +361,40 @@ void MasmDriver::WriteTypeDef(const Typedef& type)
 	std::string typeName = "";
 	CopyName(typeName, type.GetRef());
 
-	writefmt(m_cfg.fp, "{}\t\tTYPEDEF\t\t{}\n\n", type.GetName(), typeName);
+	writefmt(*m_cfg.out, "{}\t\tTYPEDEF\t\t{}\n\n", type.GetName(), typeName);
 }
 
 void MasmDriver::WriteStruct(const Struct& stru)
 {
+	AssignNames(stru);
 	PreprocessStruct(stru);
-	std::string name = stru.GetName();
-
-	if (stru.IsUnnamed())
-	{
-		m_tag_link.emplace_back(name);
-		name = "@tag_" + std::to_string(m_tag_link.size() - 1);		
-	}
+	const auto& name = stru.IsUnnamed() ? FindName(m_symbols->tag_names, &stru) : stru.GetName();
 
-	writefmt(m_cfg.fp, "{}\t\tSTRUCT {}t\n", name, stru.GetAlign() / 8);
+	writefmt(*m_cfg.out, "{}\t\tSTRUCT {}t\n", name, stru.GetAlign() / 8);
 	WriteStructMembers(stru);
-	writefmt(m_cfg.fp, "{}\t\tENDS\n\n", name);
+	writefmt(*m_cfg.out, "{}\t\tENDS\n\n", name);
 }
 
 void MasmDriver::WriteUnion(const Union& fnc)
 {
+	AssignNames(fnc);
 	PreprocessStruct(dynamic_cast<const Struct&>(fnc));
-	std::string name = fnc.GetName();
-
-	if (fnc.IsUnnamed())
-	{
-		m_tag_link.emplace_back(name);
-		name = "@tag_" + std::to_string(m_tag_link.size() - 1);
-	}
+	const auto& name = fnc.IsUnnamed() ? FindName(m_symbols->tag_names, &fnc) : fnc.GetName();
 
-	writefmt(m_cfg.fp, "{}\t\tUNION\n", name);
+	writefmt(*m_cfg.out, "{}\t\tUNION\n", name);
 	WriteStructMembers(dynamic_cast<const Struct&>(fnc));
-	writefmt(m_cfg.fp, "{}\t\tENDS\n\n", name);
+	writefmt(*m_cfg.out, "{}\t\tENDS\n\n", name);
 }
 
 void MasmDriver::WriteEnum(const Enum& fnc)
 {
 	for (const auto& p : fnc.GetFields())
 	{
-		writefmt(m_cfg.fp, "{}\t\tEQU\t\t{}t\n", p->GetName(), p->GetValue());
+		writefmt(*m_cfg.out, "{}\t\tEQU\t\t{}t\n", p->GetName(), p->GetValue());
 	}
 }
 
-void MasmDriver::WriteFunctionTypedef(const Function& fnc)
+bool MasmDriver::CopyProto(std::string& dst, const Function& fnc)
 {
 	std::string_view callType;
 	int isfirst = 1;
@@ -316,45 +403,77 @@ void MasmDriver::WriteFunctionTypedef(const Function& fnc)
 	{
 		const auto callTypeC = get_calling_string(fnc.GetCallType());
 		if (!callTypeC)
-		{
-			// MASM unsupported types
-			callType = CallType2Str(fnc.GetCallType());
-
-			if (m_cfg.verbose)
-				writefmt(m_cfg.fp, "; function {} ignored as it uses an unsupported call type ({})\n\n", fnc.GetName(), callType);
+			return false; // MASM unsupported types
 
-			return;
-		}
-		else
-			callType = callTypeC;
+		callType = callTypeC;
 	}
 
-	writefmt(m_cfg.fp, "@proto_{}\t\tTYPEDEF\t\tPROTO {} ", m_total_protos, callType);
+	dst += callType;
+	dst += " ";
 
 	// MASM does not write the return type so we skip that
 
 	for (const auto& arg : fnc.GetArguments())
 	{
-		std::string type = "";
-
 		if (isfirst)
 			isfirst = 0;
 		else
-			writefmt(m_cfg.fp, ", ");
+			dst += ", ";
 
-		CopyName(type, arg.GetRef());
-		writefmt(m_cfg.fp, ":{}", type);
+		dst += ":";
+		CopyName(dst, arg.GetRef());
 	}
 
 	if (fnc.IsVariadic())
-		writefmt(m_cfg.fp, ", :VARARG");
+		dst += ", :VARARG";
+
+	return true;
+}
+
+void MasmDriver::AssignProto(const BasicMember& owner, const Function& fnc)
+{
+	std::string proto;
+
+	if (!CopyProto(proto, fnc))
+	{
+		// not declared, but the name is still referenced
+		m_symbols->proto_names.emplace(&owner, "@proto_" + std::to_string(m_symbols->total_protos++));
+		return;
+	}
+
+	// functions with the same signature share the prototype
+	auto it = m_symbols->protos.find(proto);
 
-	writefmt(m_cfg.fp, "\n");
+	if (it == m_symbols->protos.end())
+	{
+		it = m_symbols->protos.emplace(proto, "@proto_" + std::to_string(m_symbols->total_protos++)).first;
+		m_symbols->proto_decls.emplace(&owner, proto);
+	}
+
+	m_symbols->proto_names.emplace(&owner, it->second);
+}
+
+void MasmDriver::WriteFunctionTypedef(const Function& fnc, const BasicMember& owner)
+{
+	// only the first function of a signature declares the prototype
+	const auto decl = m_symbols->proto_decls.find(&owner);
+
+	if (decl != m_symbols->proto_decls.end())
+	{
+		writefmt(*m_cfg.out, "{}\t\tTYPEDEF\t\tPROTO {}\n", FindName(m_symbols->proto_names, &owner), decl->second);
+		return;
+	}
+
+	if (m_cfg.verbose && m_cfg.platform.GetBits() != 64 && !get_calling_string(fnc.GetCallType()))
+		writefmt(*m_cfg.out, "; function {} ignored as it uses an unsupported call type ({})\n\n", fnc.GetName(), CallType2Str(fnc.GetCallType()));
 }
 
 void MasmDriver::WriteFunction(const Function& fnc)
 {
-	WriteFunctionTypedef(fnc);
+	AssignNames(fnc);
+
+	const auto& proto = FindName(m_symbols->proto_names, &fnc);
+	WriteFunctionTypedef(fnc, fnc);
 
 	std::string protoType = "PROTO";
 
@@ -366,8 +485,145 @@ void MasmDriver::WriteFunction(const Function& fnc)
 			protoType += " PTR";
 	}
 
-	writefmt(m_cfg.fp, "{}\t\t{}\t\t@proto_{}\n\n", fnc.GetName(), protoType, m_total_protos);
-	m_total_protos++;
+	writefmt(*m_cfg.out, "{}\t\t{}\t\t{}\n\n", fnc.GetName(), protoType, proto);
+}
+
+/**
+* Converts a C operator to the MASM one
+* @param op C operator
+* @return MASM operator or NULL if the operator is not supported
+*/
+static const char* get_masm_operator(const std::string& op)
+{
+	// comparisons and logical operators are not included as MASM uses -1 for true
+	static const std::pair<const char*, const char*> g_ops[] = {
+		{ "(", "(" },
+		{ ")", ")" },
+		{ "+", "+" },
+		{ "-", "-" },
+		{ "*", "*" },
+		{ "/", "/" },
+		{ "%", " MOD " },
+		{ "<<", " SHL " },
+		{ ">>", " SHR " },
+		{ "&", " AND " },
+		{ "|", " OR " },
+		{ "^", " XOR " },
+		{ "~", "NOT " },
+	};
+
+	for (const auto& p : g_ops)
+	{
+		if (op == p.first)
+			return p.second;
+	}
+
+	return nullptr;
+}
+
+/**
+* Checks if the expression of a define is a single primary expression (a number, an expression
+*  inside parenthesis or an unary operator applied to one of them).
+* C expands the defines as text while MASM uses their value, so only these defines
+*  can be referenced by name (#define A 1+2, A*3 is 7 in C and 9 in MASM)
+* @param expr Expression of the define
+* @return true if the define can be referenced by name, otherwise false
+*/
+static bool is_primary_expression(const std::vector<DefineToken>& expr, size_t first = 0)
+{
+	// a single literal has no expression
+	if (first >= expr.size())
+		return first == 0;
+
+	const auto& tok = expr[first];
+
+	switch (tok.type)
+	{
+	case DefineTokenType::Number:
+		return first + 1 == expr.size();
+
+	case DefineTokenType::Reference:
+		return first + 1 == expr.size() && tok.ref->HasNumber() && is_primary_expression(tok.ref->GetExpression());
+
+	case DefineTokenType::Operator:
+		break;
+	}
+
+	if (tok.text == "-" || tok.text == "+" || tok.text == "~")
+		return is_primary_expression(expr, first + 1);
+
+	if (tok.text != "(")
+		return false;
+
+	// the parenthesis must close at the end of the expression
+	int depth = 0;
+
+	for (auto i = first; i < expr.size(); i++)
+	{
+		if (expr[i].type != DefineTokenType::Operator)
+			continue;
+
+		if (expr[i].text == "(")
+			depth++;
+		else if (expr[i].text == ")" && --depth == 0)
+			return i + 1 == expr.size();
+	}
+
+	return false;
+}
+
+bool MasmDriver::CopyDefineExpression(std::string& dst, const Define& def)
+{
+	const auto& expr = def.GetExpression();
+	const auto value = static_cast<int64_t>(def.GetNumber());
+
+	// MASM evaluates the expressions in 32-bit
+	if (expr.empty() || value < INT32_MIN || value > UINT32_MAX)
+		return false;
+
+	const auto order = m_symbols->define_order.find(&def);
+
+	if (order == m_symbols->define_order.end())
+		return false;
+
+	for (const auto& tok : expr)
+	{
+		switch (tok.type)
+		{
+		case DefineTokenType::Operator:
+		{
+			const auto op = get_masm_operator(tok.text);
+			if (!op)
+				return false;
+
+			dst += op;
+			break;
+		}
+		case DefineTokenType::Number:
+			if (tok.number > UINT32_MAX)
+				return false;
+
+			dst += std::to_string(tok.number) + "t";
+			break;
+		case DefineTokenType::Reference:
+		{
+			// the referenced define must be already declared
+			const auto ref = m_symbols->define_order.find(tok.ref);
+
+			if (ref == m_symbols->define_order.end() || ref->second >= order->second)
+				return false;
+
+			// the value of the define is written instead
+			if (!is_primary_expression(tok.ref->GetExpression()))
+				return false;
+
+			dst += tok.ref->GetName();
+			break;
+		}
+		}
+	}
+
+	return true;
 }
 
 void MasmDriver::WriteDefine(const Define& def)
@@ -378,6 +634,8 @@ void MasmDriver::WriteDefine(const Define& def)
 	std::string prefix = "";
 	std::string cmd = "EQU";
 
+	AssignNames(def);
+
 	switch (deftype)
 	{
 	case DefineType::None:
@@ -385,7 +643,7 @@ void MasmDriver::WriteDefine(const Define& def)
 	case DefineType::Binary:
 	//case DefineType::String:
 		if (m_cfg.verbose)
-			writefmt(m_cfg.fp, "; Unsupported macro {}\n", def.GetName());
+			writefmt(*m_cfg.out, "; Unsupported macro {}\n", def.GetName());
 	
 		return;
 
@@ -409,23 +667,39 @@ void MasmDriver::WriteDefine(const Define& def)
 		break;
 	}
 
-	writefmt(m_cfg.fp, "{}\t\t{}\t\t{}{}{}\n", def.GetName(), cmd, prefix, def.GetValue(), postfix);
+	// MASM numbers must start with a digit (eg: 0ffh)
+	if (deftype == DefineType::Hexadecimal && !def.GetValue().empty() && !isdigit(def.GetValue()[0]))
+		prefix = "0";
+
+	if (!m_cfg.define_refs)
+	{
+		writefmt(*m_cfg.out, "{}\t\t{}\t\t{}{}{}\n", def.GetName(), cmd, prefix, def.GetValue(), postfix);
+		return;
+	}
+
+	std::string expr;
+
+	if (def.HasNumber() && CopyDefineExpression(expr, def))
+		writefmt(*m_cfg.out, "{}\t\t{}\t\t{}\n", def.GetName(), cmd, expr);
+	else
+		writefmt(*m_cfg.out, "{}\t\t{}\t\t{}{}{}\n", def.GetName(), cmd, prefix, def.GetValue(), postfix);
 }
 
 void MasmDriver::WriteGlobalVar(const GlobalVar& def)
 {
 	if (def.GetStorageType() == StorageType::Static)
 	{
-		if (!m_data_written)
+		AssignNames(def);
+
+		if (m_symbols->data_owner == &def)
 		{
 			// writes .DATA if we find static variables
-			writefmt(m_cfg.fp, "\n.DATA\n\n");
-			m_data_written = true;
+			writefmt(*m_cfg.out, "\n.DATA\n\n");
 		}
 
 		PreprocessVariable(def);
 		WriteVariable(def);
-		writefmt(m_cfg.fp, "\n");
+		writefmt(*m_cfg.out, "\n");
 	}
 	else
 	{
@@ -433,8 +707,110 @@ void MasmDriver::WriteGlobalVar(const GlobalVar& def)
 
 		std::string name = "";
 		CopyName(name, def.GetRef());
-		writefmt(m_cfg.fp, "EXTERNDEF\t\tC\t{}:{}\n\n", def.GetName(), name);
+		writefmt(*m_cfg.out, "EXTERNDEF\t\tC\t{}:{}\n\n", def.GetName(), name);
+	}
+}
+
+/**
+* Estimates the size of the MASM output of a file
+* @param file File to write
+* @return Expected size in bytes
+*/
+static size_t estimate_output_size(const CFile& file)
+{
+	size_t size = 0;
+
+	for (const auto type : file.GetTypes())
+	{
+		// average length of the lines written for each member
+		switch (type->GetTypeID())
+		{
+		case MemberType::Struct:
+		case MemberType::Union:
+			size += 48 + static_cast<const Struct*>(type)->GetFields().size() * 40;
+			break;
+		case MemberType::Enum:
+			size += static_cast<const Enum*>(type)->GetFields().size() * 32;
+			break;
+		default:
+			size += 48;
+			break;
+		}
+	}
+
+	return size;
+}
+
+void MasmDriver::WriteFile(const CFile& file)
+{
+	m_cfg.out->Reserve(m_cfg.out->GetPending().size() + estimate_output_size(file));
+
+	// every generated symbol gets its name before the members are written
+	for (const auto type : file.GetTypes())
+		AssignNames(*type);
+
+	const auto& types = file.GetTypes();
+	const auto jobs = std::min<size_t>(m_cfg.jobs, types.size() / ParallelChunkSize);
+
+	if (jobs > 1)
+	{
+		WriteParallel(types, jobs);
+		return;
 	}
+
+	// the driver is final, every Write* call is resolved at compile time
+	EmitMembers(*this, types.data(), types.data() + types.size());
+}
+
+void MasmDriver::WriteParallel(const std::vector<BasicMember*>& types, size_t jobs)
+{
+	// more chunks than threads, so a thread with big structures does not keep the others waiting
+	const auto chunks = std::min(jobs * 4, types.size() / ParallelChunkSize);
+	std::unique_ptr<OutputSink[]> sinks(new OutputSink[chunks]);
+	std::atomic<size_t> next(0);
+
+	const auto tracer = m_cfg.tracer;
+
+	const auto worker = [&](size_t n)
+	{
+		// the calling thread keeps its name
+		if (tracer && n > 0)
+			tracer->SetThreadName("writer " + std::to_string(n));
+
+		for (auto i = next++; i < chunks; i = next++)
+		{
+			DriverConfig cfg = m_cfg;
+			cfg.out = &sinks[i];
+
+			MasmDriver drv(m_symbols, cfg);
+			const auto first = types.size() * i / chunks;
+			const auto last = types.size() * (i + 1) / chunks;
+
+			if (tracer)
+				tracer->Begin("chunk", "members " + std::to_string(first) + "-" + std::to_string(last));
+
+			cfg.out->Reserve((last - first) * 64);
+			EmitMembers(drv, types.data() + first, types.data() + last);
+
+			if (tracer)
+				tracer->End();
+		}
+	};
+
+	std::vector<std::thread> threads;
+	threads.reserve(jobs - 1);
+
+	for (size_t i = 1; i < jobs; i++)
+		threads.emplace_back(worker, i);
+
+	worker(0);
+
+	for (auto& t : threads)
+		t.join();
+
+	// the chunks are written in the order of the members, the output is the same of the serial write
+	for (size_t i = 0; i < chunks; i++)
+		m_cfg.out->Write(sinks[i].GetPending());
 }
 
 void MasmDriver::AppendExtraDefines(std::vector<std::string>& defs)
@@ -443,8 +819,8 @@ void MasmDriver::AppendExtraDefines(std::vector<std::string>& defs)
 	defs.push_back("__MASM__");
 }
 
-const char* MasmDriver::GetName() { return "MASM CH2 Driver"; }
+const char* MasmDriver::GetName() { return Descriptor.name; }
 
-const char* MasmDriver::GetVersion() { return __TIMESTAMP__; }
+const char* MasmDriver::GetVersion() { return Descriptor.version; }
 
-const char* MasmDriver::GetAuthor() { return "lakor64"; }
+const char* MasmDriver::GetAuthor() { return Descriptor.author; }
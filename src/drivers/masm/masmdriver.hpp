@@ -7,20 +7,65 @@
 #pragma once
 
 #include <driver.hpp>
+#include <memory>
 #include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+/**
+* Names of the symbols generated by the MASM driver.
+* The names are assigned before writing the members, after that the table is only read
+*  so it can be shared with the workers of the parallel write
+*/
+struct MasmSymbols
+{
+	/**
+	* Default constructor
+	*/
+	explicit MasmSymbols() : total_typedefs(0), total_protos(0), total_tags(0), total_defines(0), data_owner(nullptr) {}
+
+	/** total pointer typedefs */
+	int64_t total_typedefs;
+	/** total function protos */
+	int64_t total_protos;
+	/** total tags of the unnamed structures */
+	int64_t total_tags;
+	/** total written defines */
+	int64_t total_defines;
+	/** static variable that writes the .DATA command */
+	const BasicMember* data_owner;
+	/** members that already have their names */
+	std::unordered_set<const BasicMember*> named;
+	/** tag of the unnamed structures and unions */
+	std::unordered_map<const BasicMember*, std::string> tag_names;
+	/** pointer typedef of the variables */
+	std::unordered_map<const BasicMember*, std::string> typedef_names;
+	/** pointer typedefs by the declared type (eg: PTR SDWORD) */
+	std::unordered_map<std::string, std::string> ptr_typedefs;
+	/** type of the pointer typedefs declared by the variables that use them first */
+	std::unordered_map<const BasicMember*, std::string> typedef_decls;
+	/** prototype of the functions and of the variables that reference a function */
+	std::unordered_map<const BasicMember*, std::string> proto_names;
+	/** prototypes by their signature */
+	std::unordered_map<std::string, std::string> protos;
+	/** signature of the prototypes declared by the members that use them first */
+	std::unordered_map<const BasicMember*, std::string> proto_decls;
+	/** position of the defines in the file, a define can only reference the defines written before it */
+	std::unordered_map<const BasicMember*, int64_t> define_order;
+};
 
 class MasmDriver final : public Driver
 {
 public:
+	/** descriptor of the driver */
+	static const DriverDescriptor Descriptor;
+
 	/**
 	* Default constructor
 	*/
 	explicit MasmDriver()
 		: Driver()
-		, m_total_preprocess_typedef(0)
-		, m_total_used_typedef(0)
-		, m_total_protos(0)
-		, m_data_written(false)
+		, m_symbols(std::make_shared<MasmSymbols>())
 	{}
 
 	/**
@@ -116,12 +161,67 @@ public:
 	*/
 	void WriteGlobalVar(const GlobalVar& def) override;
 
+	/**
+	* Writes all the members of a file
+	* @param file File to write
+	*/
+	void WriteFile(const CFile& file) override;
+
 private:
+	/** minimum number of members written by a thread of the parallel write */
+	static constexpr size_t ParallelChunkSize = 256;
+
 	/**
-	* Writes a function typedef
+	* Writes the members on multiple threads, each thread writes a chunk of members
+	*  in its own buffer and the buffers are written in the order of the members
+	* @param types Members to write
+	* @param jobs Number of threads
+	*/
+	void WriteParallel(const std::vector<BasicMember*>& types, size_t jobs);
+
+	/**
+	* Assigns the names of the symbols generated for a member (tags, pointer typedefs and prototypes),
+	*  the names are only assigned the first time the member is found
+	* @param type Member to check
+	*/
+	void AssignNames(const BasicMember& type);
+
+	/**
+	* Assigns the names of the symbols generated for a variable
+	* @param v Variable to check
+	*/
+	void AssignVariableNames(const Variable& v);
+
+	/**
+	* Gets the name of a symbol generated for a member
+	* @param names Table of the names
+	* @param type Member that generated the symbol
+	* @return Name of the symbol or an empty string if the member does not have one
+	*/
+	static const std::string& FindName(const std::unordered_map<const BasicMember*, std::string>& names, const BasicMember* type);
+
+	/**
+	* Assigns the prototype of a function, functions with the same call type, arguments
+	*  and variadic flag share the same prototype
+	* @param owner Function or variable that uses the prototype
 	* @param fnc Function type
 	*/
-	void WriteFunctionTypedef(const Function& fnc);
+	void AssignProto(const BasicMember& owner, const Function& fnc);
+
+	/**
+	* Writes the signature of a function prototype (eg: C :SDWORD, :VARARG)
+	* @param dst Destination string
+	* @param fnc Function type
+	* @return false if the call type is not supported by MASM, otherwise true
+	*/
+	bool CopyProto(std::string& dst, const Function& fnc);
+
+	/**
+	* Writes a function typedef, if the owner is the first user of the prototype
+	* @param fnc Function type
+	* @param owner Function or variable that uses the prototype
+	*/
+	void WriteFunctionTypedef(const Function& fnc, const BasicMember& owner);
 
 	/**
 	* Adjust the type name of a link name
@@ -141,7 +241,7 @@ private:
 	* MASM does not directly support type declarations of pointers, so we need to generate
 	* a new typedef and put them there.
 	* This code will preprocess the variable and verify if we need to insert a TYPEDEF before the
-	* type delcaration.
+	* type delcaration, every distinct pointer type is only declared once.
 	* @param link Link to preprocess
 	*/
 	void PreprocessVariable(const Variable& link);
@@ -152,6 +252,14 @@ private:
 	*/
 	void WriteStructMembers(const Struct& stru);
 
+	/**
+	* Writes the expression of a define as a reference to the other defines
+	* @param dst Destination string
+	* @param def Define to write
+	* @return true if the expression can be written in MASM, otherwise false
+	*/
+	bool CopyDefineExpression(std::string& dst, const Define& def);
+
 	/**
 	* Writes a variable
 	* @param link Type link
@@ -159,14 +267,18 @@ private:
 	*/
 	void WriteVariable(const Variable& v);
 
-	/** total preprocessed custom typedefs */
-	int64_t m_total_preprocess_typedef;
-	/** total used custom typedefs */
-	int64_t m_total_used_typedef;
-	/** total function protos */
-	int64_t m_total_protos;
-	/** total used tags */
-	std::vector<std::string> m_tag_link;
-	/** written the .DATA command */
-	bool m_data_written;
+	/**
+	* Constructor of the workers of the parallel write
+	* @param symbols Symbols of the driver that owns the worker
+	* @param cfg Config of the worker
+	*/
+	explicit MasmDriver(const std::shared_ptr<MasmSymbols>& symbols, const DriverConfig& cfg)
+		: Driver()
+		, m_symbols(symbols)
+	{
+		m_cfg = cfg;
+	}
+
+	/** names of the generated symbols */
+	std::shared_ptr<MasmSymbols> m_symbols;
 };
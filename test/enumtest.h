@@ -14,3 +14,18 @@ typedef enum b
 {
 	B_1,
 } b;
+
+enum c
+{
+	C_1 = 0x80,
+};
+
+typedef enum c small_c;
+
+struct with_enums
+{
+	enum a first;
+	b second;
+	small_c third;
+	enum a* fourth;
+};
@@ -0,0 +1,14 @@
+#pragma once
+
+// nothing of this header is an error without the include, the fast parse must see the #include
+#include "fastinclude/types.h"
+
+#define LIST_SIZE (INC_SIZE * 2)
+
+typedef struct inc_node* inc_list;
+
+struct list_head
+{
+	inc_list first;
+	int count;
+};
@@ -0,0 +1,11 @@
+#pragma once
+
+#define INC_SIZE 4
+
+typedef unsigned short inc_word;
+
+struct inc_node
+{
+	inc_word id;
+	struct inc_node* next;
+};
@@ -0,0 +1,204 @@
+# Runs ch2inc on a test header, compares the output with the expected one and
+#  checks the time of the conversion against the baseline.
+# Set the CH2_UPDATE_GOLDEN environment variable to write the expected output instead.
+
+cmake_minimum_required(VERSION 3.20)
+
+# Converts a decimal number to thousandths (eg: 3.25 -> 3250)
+function(to_milli value out)
+    if (value MATCHES "^([0-9]+)\\.([0-9]*)$")
+        set(int_part "${CMAKE_MATCH_1}")
+        string(SUBSTRING "${CMAKE_MATCH_2}000" 0 3 frac_part)
+    elseif (value MATCHES "^[0-9]+$")
+        set(int_part "${value}")
+        set(frac_part "000")
+    else()
+        message(FATAL_ERROR "Invalid number: ${value}")
+    endif()
+
+    math(EXPR result "${int_part} * 1000 + 1${frac_part} - 1000")
+    set(${out} ${result} PARENT_SCOPE)
+endfunction()
+
+# Reads a ch2inc output without the generation timestamp
+function(read_output path out)
+    file(READ "${path}" text)
+    string(REGEX REPLACE "This file was generated by CH2Inc on [^\n]*\n" "" text "${text}")
+    set(${out} "${text}" PARENT_SCOPE)
+endfunction()
+
+# Gets the size in bytes of a STRUCT of the MASM output, only the types used by the tests are known
+function(masm_struct_size text name out)
+    if (NOT text MATCHES "\n${name}\t\tSTRUCT[^\n]*\n(.*)\n${name}\t\tENDS")
+        message(FATAL_ERROR "The output does not contain the structure ${name}")
+    endif()
+
+    # the comments would split the list of lines
+    string(REGEX REPLACE "(^|\n);[^\n]*" "" body "${CMAKE_MATCH_1}")
+    string(REPLACE "\n" ";" lines "${body}")
+
+    set(size 0)
+    set(record "")
+
+    foreach(line ${lines})
+        if (line MATCHES "^(rec@[^\t ]+)[\t ]+RECORD")
+            set(record "${CMAKE_MATCH_1}")
+            set(width 0)
+        endif()
+
+        if (record)
+            string(REGEX MATCHALL ":[0-9]+" bits "${line}")
+
+            foreach(b ${bits})
+                string(SUBSTRING "${b}" 1 -1 b)
+                math(EXPR width "${width} + ${b}")
+            endforeach()
+
+            # the last line of a RECORD does not end with a comma
+            if (NOT line MATCHES ",$")
+                if (width LESS_EQUAL 8)
+                    set("${record}" 1)
+                elseif (width LESS_EQUAL 16)
+                    set("${record}" 2)
+                elseif (width LESS_EQUAL 32)
+                    set("${record}" 4)
+                else()
+                    set("${record}" 8)
+                endif()
+
+                set(record "")
+            endif()
+        elseif (line MATCHES "^[^\t ]+[\t ]+(rec@[^\t ]+) <>")
+            math(EXPR size "${size} + ${${CMAKE_MATCH_1}}")
+        elseif (line MATCHES "^[^\t ]+[\t ]+BYTE ([0-9]+)t DUP \\(\\?\\)")
+            math(EXPR size "${size} + ${CMAKE_MATCH_1}")
+        elseif (line MATCHES "^[^\t ]+[\t ]+S?BYTE[\t ]+\\?")
+            math(EXPR size "${size} + 1")
+        elseif (line MATCHES "^[^\t ]+[\t ]+S?WORD[\t ]+\\?")
+            math(EXPR size "${size} + 2")
+        elseif (line MATCHES "^[^\t ]+[\t ]+S?DWORD[\t ]+\\?")
+            math(EXPR size "${size} + 4")
+        elseif (line MATCHES "^[^\t ]+[\t ]+S?QWORD[\t ]+\\?")
+            math(EXPR size "${size} + 8")
+        elseif (NOT line STREQUAL "")
+            message(FATAL_ERROR "Cannot compute the size of ${name}, unknown line: ${line}")
+        endif()
+    endforeach()
+
+    set(${out} ${size} PARENT_SCOPE)
+endfunction()
+
+# a header can replace the platform options with a "// ch2inc: <options>" line
+set(platform_args -p win -b 32)
+file(STRINGS "${INPUT}" platform_line REGEX "^// ch2inc: " LIMIT_COUNT 1)
+
+if (platform_line)
+    string(REGEX REPLACE "^// ch2inc: " "" platform_line "${platform_line}")
+    separate_arguments(platform_args UNIX_COMMAND "${platform_line}")
+endif()
+
+# a variant of the case replaces --only-int-macros with the options of its "<header>.<variant>.opts" file
+set(case_args --only-int-macros)
+
+if (OPTIONS)
+    file(READ "${OPTIONS}" case_line)
+    string(STRIP "${case_line}" case_line)
+    separate_arguments(case_args UNIX_COMMAND "${case_line}")
+endif()
+
+set(args ${case_args} --msvc --nologo --time-report=json ${platform_args})
+
+if (DRIVER)
+    list(APPEND args -d "${DRIVER}")
+endif()
+
+get_filename_component(output_dir "${OUTPUT}" DIRECTORY)
+get_filename_component(timing_dir "${TIMING}" DIRECTORY)
+file(MAKE_DIRECTORY "${output_dir}" "${timing_dir}")
+
+set(best_us -1)
+
+foreach(run RANGE 1 ${RUNS})
+    execute_process(COMMAND "${CH2INC}" ${args} "${INPUT}" "${OUTPUT}"
+        RESULT_VARIABLE result
+        OUTPUT_VARIABLE stdout
+        ERROR_VARIABLE stderr)
+
+    if (NOT result EQUAL 0)
+        message(FATAL_ERROR "ch2inc failed (${result}):\n${stdout}${stderr}")
+    endif()
+
+    # the time report is the only JSON line of the output
+    string(REGEX MATCH "{\"phases\":[^\n]*" report "${stdout}")
+    string(JSON wall_ms GET "${report}" total wall_ms)
+    to_milli(${wall_ms} wall_us)
+
+    if (best_us LESS 0 OR wall_us LESS best_us)
+        set(best_us ${wall_us})
+    endif()
+endforeach()
+
+read_output("${OUTPUT}" actual)
+
+if (DEFINED ENV{CH2_UPDATE_GOLDEN})
+    file(WRITE "${EXPECTED}" "${actual}")
+    message(STATUS "Updated ${EXPECTED}")
+elseif (NOT EXISTS "${EXPECTED}")
+    message(FATAL_ERROR "Missing expected output ${EXPECTED}")
+else()
+    read_output("${EXPECTED}" expected)
+
+    if (NOT actual STREQUAL expected)
+        execute_process(COMMAND diff -u -I "^This file was generated by CH2Inc on " "${EXPECTED}" "${OUTPUT}" OUTPUT_VARIABLE diff)
+        message(FATAL_ERROR "Output of ${INPUT} differs from ${EXPECTED}:\n${diff}")
+    endif()
+endif()
+
+# every "_Static_assert(sizeof(struct x) == n" of the header must match the size of the written STRUCT
+file(STRINGS "${INPUT}" asserts REGEX "_Static_assert\\(sizeof\\(struct [A-Za-z0-9_]+\\) == [0-9]+")
+
+foreach(line ${asserts})
+    string(REGEX MATCH "sizeof\\(struct ([A-Za-z0-9_]+)\\) == ([0-9]+)" unused "${line}")
+    set(struct_name "${CMAKE_MATCH_1}")
+    set(struct_size "${CMAKE_MATCH_2}")
+    masm_struct_size("${actual}" ${struct_name} written_size)
+
+    if (NOT written_size EQUAL struct_size)
+        message(FATAL_ERROR "${struct_name} is written as ${written_size} bytes, sizeof is ${struct_size}")
+    endif()
+endforeach()
+
+file(WRITE "${TIMING}" "${best_us}")
+message(STATUS "${INPUT}: ${best_us} us")
+
+# the variants have their own timing
+get_filename_component(name "${TIMING}" NAME)
+string(REGEX REPLACE "\\.us$" "" name "${name}")
+
+if (NOT EXISTS "${BASELINE}")
+    message(STATUS "No timing baseline, the time is not checked")
+    return()
+endif()
+
+file(READ "${BASELINE}" baseline)
+string(JSON base_ms ERROR_VARIABLE missing GET "${baseline}" "${name}")
+
+if (missing)
+    message(STATUS "${name} is not in the timing baseline, the time is not checked")
+    return()
+endif()
+
+to_milli(${base_ms} base_us)
+to_milli(${FACTOR} factor_milli)
+to_milli(${FLOOR_MS} floor_us)
+
+math(EXPR limit_us "${base_us} * ${factor_milli} / 1000")
+math(EXPR floor_limit_us "${base_us} + ${floor_us}")
+
+if (limit_us LESS floor_limit_us)
+    set(limit_us ${floor_limit_us})
+endif()
+
+if (best_us GREATER limit_us)
+    message(FATAL_ERROR "${name} took ${best_us} us, the baseline is ${base_us} us (limit ${limit_us} us)")
+endif()
@@ -0,0 +1,19 @@
+#pragma once
+
+/* the numbers of an expression can have different radixes */
+#define F 0x10
+#define H (1+F)
+#define A 10
+#define E 10/A
+#define M (F|010|0b11)
+
+/* the referenced defines are expanded as text */
+#define S 1+2
+#define T S*3
+#define U (S)*3
+#define V -S
+#define W T+T
+
+/* a define is not expanded inside its own expansion */
+#define R1 R2+1
+#define R2 R1+1
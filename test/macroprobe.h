@@ -0,0 +1,23 @@
+#pragma once
+
+struct probe_rec
+{
+	int a;
+	short b;
+	char c[6];
+};
+
+enum probe_kind
+{
+	PROBE_FIRST = 3,
+	PROBE_LAST = 9,
+};
+
+#define REC_SIZE sizeof(struct probe_rec)
+#define REC_WORDS (sizeof(struct probe_rec) / sizeof(short))
+#define INT_SIZE sizeof(int)
+#define BYTE_MASK ((unsigned char)0x1ff)
+#define NEG_ONE ((int)-1)
+#define KIND_COUNT (PROBE_LAST - PROBE_FIRST + 1)
+#define KIND_LAST PROBE_LAST
+#define PLAIN 42
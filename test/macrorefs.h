@@ -0,0 +1,20 @@
+// ch2inc: --macro-refs -p win -b 32
+#pragma once
+
+/* single primary expressions are written as references */
+#define F 0x10
+#define N -4
+#define P (F+1)
+#define G F*2
+#define Q N+P
+
+/* C expands the defines as text, MASM uses their value: the value is written */
+#define S 1+2
+#define T S*3
+#define B S
+#define C B*3
+
+/* the binary define is dropped by --only-int-macros, its references become numbers */
+#define BN 0b101
+#define BC BN+1
+#define BG (BN)*2
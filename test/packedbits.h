@@ -0,0 +1,40 @@
+// ch2inc: -p linux -b 32
+#pragma once
+
+#pragma pack(1)
+
+/* the bitfields cross the natural units of their types */
+struct z
+{
+	int a : 20;
+	short q : 10;
+	short l : 6;
+	char p : 2;
+	char q2 : 3;
+	char aa : 2;
+	char oo : 1;
+};
+
+_Static_assert(sizeof(struct z) == 6, "z");
+
+/* the bitfield starts inside the unit of the previous field */
+struct w
+{
+	char c;
+	int b : 20;
+	char d;
+};
+
+_Static_assert(sizeof(struct w) == 5, "w");
+
+/* the unit of the bitfield is larger than the space before the next field */
+struct v
+{
+	int a : 12;
+	char b;
+	short c : 4;
+};
+
+_Static_assert(sizeof(struct v) == 4, "v");
+
+#pragma pack()
@@ -0,0 +1,44 @@
+# Converts a generated header with a single thread and with multiple threads,
+#  the two outputs must be the same.
+
+cmake_minimum_required(VERSION 3.20)
+
+set(args --only-int-macros --msvc --nologo --macro-refs -p win -b 32)
+
+if (DRIVER)
+    list(APPEND args -d "${DRIVER}")
+endif()
+
+file(MAKE_DIRECTORY "${OUTPUT_DIR}")
+
+# enough members for more than one chunk
+execute_process(
+    COMMAND "${CH2GEN}" --preset small --structs 300 --functions 600 --callbacks 100 --macros 100 --output "${OUTPUT_DIR}/parallel.h"
+    RESULT_VARIABLE result)
+
+if (NOT result EQUAL 0)
+    message(FATAL_ERROR "ch2gen failed (${result})")
+endif()
+
+foreach(jobs 1 4)
+    execute_process(
+        COMMAND "${CH2INC}" ${args} -j ${jobs} "${OUTPUT_DIR}/parallel.h" "${OUTPUT_DIR}/parallel_j${jobs}.inc"
+        WORKING_DIRECTORY "${OUTPUT_DIR}"
+        RESULT_VARIABLE result
+        OUTPUT_VARIABLE stdout
+        ERROR_VARIABLE stderr)
+
+    if (NOT result EQUAL 0)
+        message(FATAL_ERROR "ch2inc -j ${jobs} failed (${result}):\n${stdout}${stderr}")
+    endif()
+endforeach()
+
+execute_process(
+    COMMAND ${CMAKE_COMMAND} -E compare_files "${OUTPUT_DIR}/parallel_j1.inc" "${OUTPUT_DIR}/parallel_j4.inc"
+    RESULT_VARIABLE result)
+
+if (NOT result EQUAL 0)
+    message(FATAL_ERROR "The output of the parallel write differs from the serial one:\n"
+        "  ${OUTPUT_DIR}/parallel_j1.inc\n"
+        "  ${OUTPUT_DIR}/parallel_j4.inc")
+endif()
@@ -0,0 +1,19 @@
+#pragma once
+
+struct node
+{
+    int* a;
+    int* b;
+    char** names;
+    struct node* next;
+    struct node* prev;
+};
+
+struct list
+{
+    struct node* head;
+    int* counts;
+    char** labels;
+};
+
+static int* g_counts;
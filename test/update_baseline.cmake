@@ -0,0 +1,40 @@
+# Stores the timings of the last test run as the timing baseline
+
+cmake_minimum_required(VERSION 3.20)
+
+# a routine run must not modify the checkout
+cmake_path(IS_PREFIX SOURCE_DIR "${BASELINE}" NORMALIZE in_source)
+
+if (in_source AND NOT ALLOW_SOURCE)
+    message(FATAL_ERROR "${BASELINE} is inside the source tree, configure with -DCH2_TEST_BASELINE_IN_SOURCE=ON to write it")
+endif()
+
+file(GLOB timings "${TIMINGS}/*.us")
+
+if (NOT timings)
+    message(FATAL_ERROR "No timings found in ${TIMINGS}, run the tests first")
+endif()
+
+set(json "")
+
+foreach(timing ${timings})
+    get_filename_component(name "${timing}" NAME)
+    string(REGEX REPLACE "\\.us$" "" name "${name}")
+    file(READ "${timing}" us)
+    string(STRIP "${us}" us)
+
+    # milliseconds with three decimals
+    math(EXPR ms "${us} / 1000")
+    math(EXPR frac "${us} % 1000 + 1000")
+    string(SUBSTRING "${frac}" 1 3 frac)
+    if (json)
+        string(APPEND json ",\n")
+    endif()
+
+    string(APPEND json "  \"${name}\": ${ms}.${frac}")
+endforeach()
+
+get_filename_component(dir "${BASELINE}" DIRECTORY)
+file(MAKE_DIRECTORY "${dir}")
+file(WRITE "${BASELINE}" "{\n${json}\n}\n")
+message(STATUS "Baseline written to ${BASELINE}")